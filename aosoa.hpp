@@ -0,0 +1,189 @@
+#pragma once
+
+#include "scimd.hpp"
+#include "soa.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 	Array-of-structures-of-arrays storage
+ *
+ * 	aosoa<T, Fields> groups the elements into tiles of pack<T>::size. Each
+ * 	tile stores its elements field by field, so
+ *
+ * 		tile t: [f0 of elements 0..W-1][f1 of elements 0..W-1]...
+ *
+ * 	One aligned pack load fetches a field for the whole tile, as with
+ * 	soa, while all fields of an element stay within Fields * sizeof(pack<T>)
+ * 	bytes (e.g., four cache lines for four float fields with AVX-512).
+ *
+ * 	The last tile is padded with zeros.
+ */
+namespace scimd { inline namespace SCIMD_ISA_NAMESPACE {
+
+	template <typename T, size_t Fields>
+	class aosoa {
+		static_assert(Fields > 0, "An aosoa needs at least one field");
+		static_assert(std::is_floating_point<T>::value, "aosoa fields must be floating-point types");
+
+	public:
+		using value_type = T;
+		using pack_type = pack<T>;
+
+		static constexpr size_t fields = Fields;
+		static constexpr size_t lanes = pack_type::size;
+		static constexpr size_t tile_size = Fields * lanes;
+
+		aosoa() = default;
+		explicit aosoa(size_t n) { resize(n); }
+
+		size_t size() const noexcept { return size_; }
+		bool empty() const noexcept { return size_ == 0; }
+		size_t tiles() const noexcept { return (size_ + lanes - 1) / lanes; }
+
+		/**
+		 * \brief Change the number of elements
+		 *
+		 * New elements are zero, as are the padding lanes.
+		 */
+		void resize(size_t n) {
+			size_t const old = size_;
+			size_ = n;
+			data_.resize(tiles() * tile_size);
+			for (size_t i = n; i < std::min(old, tiles() * lanes); i++) {
+				for (size_t f = 0; f < Fields; f++) {
+					get(f, i) = T{0};
+				}
+			}
+		}
+		void reserve(size_t n) { data_.reserve((n + lanes - 1) / lanes * tile_size); }
+		void clear() { resize(0); }
+
+		T& get(size_t field, size_t i) { return data_[offset(field, i)]; }
+		T const& get(size_t field, size_t i) const { return data_[offset(field, i)]; }
+
+		/**
+		 * \brief The start of tile `t`, aligned for pack<T>
+		 */
+		T* tile(size_t t) noexcept { return data_.data() + t * tile_size; }
+		T const* tile(size_t t) const noexcept { return data_.data() + t * tile_size; }
+
+		/**
+		 * \brief Load/store `field` of all elements of tile `t`
+		 */
+		pack_type load(size_t t, size_t field) const {
+			pack_type x;
+			x.load(memory::aligned{}, tile(t) + field * lanes);
+			return x;
+		}
+		void store(size_t t, size_t field, pack_type x) {
+			x.store(memory::aligned{}, tile(t) + field * lanes);
+		}
+
+		/* ----------------------------------------------------------
+		 * 			Conversions
+		 *---------------------------------------------------------*/
+		/**
+		 * \brief Copy `n` structures of `Fields` consecutive T's
+		 *
+		 * `p` is typically an array of `struct { T x, y, z; }`.
+		 */
+		void from_aos(T const* p, size_t n) {
+			resize(n);
+			size_t const full = n / lanes;
+			auto const idx = stride();
+			for (size_t t = 0; t < full; t++) {
+				for (size_t f = 0; f < Fields; f++) {
+					store(t, f, ::gather(p + t * tile_size + f, idx));
+				}
+			}
+			for (size_t i = full * lanes; i < n; i++) {
+				for (size_t f = 0; f < Fields; f++) {
+					get(f, i) = p[i * Fields + f];
+				}
+			}
+		}
+
+		/**
+		 * \brief Copy the elements into size() structures of `Fields` consecutive T's
+		 */
+		void to_aos(T* p) const {
+			size_t const full = size_ / lanes;
+			auto const idx = stride();
+			for (size_t t = 0; t < full; t++) {
+				for (size_t f = 0; f < Fields; f++) {
+					::scatter(p + t * tile_size + f, idx, load(t, f));
+				}
+			}
+			for (size_t i = full * lanes; i < size_; i++) {
+				for (size_t f = 0; f < Fields; f++) {
+					p[i * Fields + f] = get(f, i);
+				}
+			}
+		}
+
+		template <typename... U>
+		void from_soa(soa<U...> const& s) {
+			check_soa<U...>();
+			resize(s.size());
+			copy_from(s, typename detail::make_index_sequence<Fields>::type{});
+		}
+		template <typename... U>
+		void to_soa(soa<U...>& s) const {
+			check_soa<U...>();
+			s.resize(size_);
+			copy_to(s, typename detail::make_index_sequence<Fields>::type{});
+		}
+
+	private:
+		std::vector<T, allocator<T>> data_;
+		size_t size_{0};
+
+		static size_t offset(size_t field, size_t i) noexcept {
+			return (i / lanes) * tile_size + field * lanes + i % lanes;
+		}
+
+		static index_pack<T> stride() {
+			int32_t s[lanes];
+			for (size_t i = 0; i < lanes; i++) {
+				s[i] = static_cast<int32_t>(i * Fields);
+			}
+			index_pack<T> idx;
+			idx.load(s);
+			return idx;
+		}
+
+		template <typename... U>
+		static void check_soa() {
+			static_assert(sizeof...(U) == Fields, "The soa must have one column per field");
+			static_assert(detail::all_true<std::is_same<U, T>::value...>::value,
+						  "The soa columns must have the same type as the aosoa");
+		}
+
+		/*
+		 * 	The soa columns are padded to a multiple of pack<T>::size,
+		 * 	so they cover every tile.
+		 */
+		template <typename S, size_t... I>
+		void copy_from(S const& s, detail::index_sequence<I...>) {
+			detail::expand({(copy_from(I, s.template data<I>()), 0)...});
+		}
+		void copy_from(size_t field, T const* column) {
+			for (size_t t = 0; t < tiles(); t++) {
+				pack_type x;
+				x.load(memory::aligned{}, column + t * lanes);
+				store(t, field, x);
+			}
+		}
+		template <typename S, size_t... I>
+		void copy_to(S& s, detail::index_sequence<I...>) const {
+			detail::expand({(copy_to(I, s.template data<I>()), 0)...});
+		}
+		void copy_to(size_t field, T* column) const {
+			for (size_t t = 0; t < tiles(); t++) {
+				load(t, field).store(memory::aligned{}, column + t * lanes);
+			}
+		}
+	};
+}}
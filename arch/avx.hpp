@@ -2,14 +2,19 @@
 
 #include <immintrin.h>
 #include <cstdint>
+#include <limits>
 #include "traits.hpp"
 #include "memory.hpp"
+#include "precision.hpp"
 
-namespace scimd {
+namespace scimd { inline namespace SCIMD_ISA_NAMESPACE {
 
 	struct avx_tag {};
 
 	template <> struct is_avx<avx_tag> : std::true_type {};
+#ifdef __FMA__
+	template <> struct has_fma<avx_tag> : std::true_type {};
+#endif
 
 	struct simd_category { using type = avx_tag; };
 
@@ -19,11 +24,66 @@ namespace scimd {
 	template <> struct bool_type<float> { using type = __m256; };
 	template <> struct bool_type<double> { using type = __m256d; };
 
+	template <> struct index_type<float> { using type = __m256i; };
+	template <> struct index_type<double> { using type = __m128i; };
+	template <> struct index_type<double, int64_t> { using type = __m256i; };
+
 	namespace {
 		template <typename T>
 		struct mask_t {};
 		template<> struct mask_t<float> { static const int value = 0xff; };
 		template<> struct mask_t<double> { static const int value = 0xf; };
+
+		/*
+		 * 	Sliding windows for the partial load/store masks. The mask with
+		 * 	the first n lanes set starts at offset (lanes - n).
+		 */
+		alignas(32) const int32_t tail_mask32[16] = {-1, -1, -1, -1, -1, -1, -1, -1, 0, 0, 0, 0, 0, 0, 0, 0};
+		alignas(32) const int64_t tail_mask64[8] = {-1, -1, -1, -1, 0, 0, 0, 0};
+#ifdef __AVX2__
+		/*
+		 * 	Permutations for compress, indexed by the movemask. Nibble k of an
+		 * 	entry is the 32-bit lane moved to lane k.
+		 */
+		const uint32_t compress_lut32[256] = {
+			0x00000000, 0x00000000, 0x00000001, 0x00000010, 0x00000002, 0x00000020, 0x00000021, 0x00000210,
+			0x00000003, 0x00000030, 0x00000031, 0x00000310, 0x00000032, 0x00000320, 0x00000321, 0x00003210,
+			0x00000004, 0x00000040, 0x00000041, 0x00000410, 0x00000042, 0x00000420, 0x00000421, 0x00004210,
+			0x00000043, 0x00000430, 0x00000431, 0x00004310, 0x00000432, 0x00004320, 0x00004321, 0x00043210,
+			0x00000005, 0x00000050, 0x00000051, 0x00000510, 0x00000052, 0x00000520, 0x00000521, 0x00005210,
+			0x00000053, 0x00000530, 0x00000531, 0x00005310, 0x00000532, 0x00005320, 0x00005321, 0x00053210,
+			0x00000054, 0x00000540, 0x00000541, 0x00005410, 0x00000542, 0x00005420, 0x00005421, 0x00054210,
+			0x00000543, 0x00005430, 0x00005431, 0x00054310, 0x00005432, 0x00054320, 0x00054321, 0x00543210,
+			0x00000006, 0x00000060, 0x00000061, 0x00000610, 0x00000062, 0x00000620, 0x00000621, 0x00006210,
+			0x00000063, 0x00000630, 0x00000631, 0x00006310, 0x00000632, 0x00006320, 0x00006321, 0x00063210,
+			0x00000064, 0x00000640, 0x00000641, 0x00006410, 0x00000642, 0x00006420, 0x00006421, 0x00064210,
+			0x00000643, 0x00006430, 0x00006431, 0x00064310, 0x00006432, 0x00064320, 0x00064321, 0x00643210,
+			0x00000065, 0x00000650, 0x00000651, 0x00006510, 0x00000652, 0x00006520, 0x00006521, 0x00065210,
+			0x00000653, 0x00006530, 0x00006531, 0x00065310, 0x00006532, 0x00065320, 0x00065321, 0x00653210,
+			0x00000654, 0x00006540, 0x00006541, 0x00065410, 0x00006542, 0x00065420, 0x00065421, 0x00654210,
+			0x00006543, 0x00065430, 0x00065431, 0x00654310, 0x00065432, 0x00654320, 0x00654321, 0x06543210,
+			0x00000007, 0x00000070, 0x00000071, 0x00000710, 0x00000072, 0x00000720, 0x00000721, 0x00007210,
+			0x00000073, 0x00000730, 0x00000731, 0x00007310, 0x00000732, 0x00007320, 0x00007321, 0x00073210,
+			0x00000074, 0x00000740, 0x00000741, 0x00007410, 0x00000742, 0x00007420, 0x00007421, 0x00074210,
+			0x00000743, 0x00007430, 0x00007431, 0x00074310, 0x00007432, 0x00074320, 0x00074321, 0x00743210,
+			0x00000075, 0x00000750, 0x00000751, 0x00007510, 0x00000752, 0x00007520, 0x00007521, 0x00075210,
+			0x00000753, 0x00007530, 0x00007531, 0x00075310, 0x00007532, 0x00075320, 0x00075321, 0x00753210,
+			0x00000754, 0x00007540, 0x00007541, 0x00075410, 0x00007542, 0x00075420, 0x00075421, 0x00754210,
+			0x00007543, 0x00075430, 0x00075431, 0x00754310, 0x00075432, 0x00754320, 0x00754321, 0x07543210,
+			0x00000076, 0x00000760, 0x00000761, 0x00007610, 0x00000762, 0x00007620, 0x00007621, 0x00076210,
+			0x00000763, 0x00007630, 0x00007631, 0x00076310, 0x00007632, 0x00076320, 0x00076321, 0x00763210,
+			0x00000764, 0x00007640, 0x00007641, 0x00076410, 0x00007642, 0x00076420, 0x00076421, 0x00764210,
+			0x00007643, 0x00076430, 0x00076431, 0x00764310, 0x00076432, 0x00764320, 0x00764321, 0x07643210,
+			0x00000765, 0x00007650, 0x00007651, 0x00076510, 0x00007652, 0x00076520, 0x00076521, 0x00765210,
+			0x00007653, 0x00076530, 0x00076531, 0x00765310, 0x00076532, 0x00765320, 0x00765321, 0x07653210,
+			0x00007654, 0x00076540, 0x00076541, 0x00765410, 0x00076542, 0x00765420, 0x00765421, 0x07654210,
+			0x00076543, 0x00765430, 0x00765431, 0x07654310, 0x00765432, 0x07654320, 0x07654321, 0x76543210
+		};
+		const uint32_t compress_lut64[16] = {
+			0x00000000, 0x00000010, 0x00000032, 0x00003210, 0x00000054, 0x00005410, 0x00005432, 0x00543210,
+			0x00000076, 0x00007610, 0x00007632, 0x00763210, 0x00007654, 0x00765410, 0x00765432, 0x76543210
+		};
+#endif
 	}
 
 	/**
@@ -73,6 +133,66 @@ namespace scimd {
 	static inline __m256d div(__m256d x, __m256d y, double, avx_tag) {
 		return _mm256_div_pd(x, y);
 	}
+	/*************************************************************************/
+	/**
+	 * 	Fused multiply-add family
+	 *
+	 * 	fma:  x*y + z	fms:  x*y - z
+	 * 	fnma: z - x*y	fnms: -(x*y) - z
+	 *
+	 * 	Without FMA hardware, these fall back to a separate multiply and add.
+	 */
+#ifdef __FMA__
+	static inline __m256 fma(__m256 x, __m256 y, __m256 z, float, avx_tag) {
+		return _mm256_fmadd_ps(x, y, z);
+	}
+	static inline __m256d fma(__m256d x, __m256d y, __m256d z, double, avx_tag) {
+		return _mm256_fmadd_pd(x, y, z);
+	}
+	static inline __m256 fms(__m256 x, __m256 y, __m256 z, float, avx_tag) {
+		return _mm256_fmsub_ps(x, y, z);
+	}
+	static inline __m256d fms(__m256d x, __m256d y, __m256d z, double, avx_tag) {
+		return _mm256_fmsub_pd(x, y, z);
+	}
+	static inline __m256 fnma(__m256 x, __m256 y, __m256 z, float, avx_tag) {
+		return _mm256_fnmadd_ps(x, y, z);
+	}
+	static inline __m256d fnma(__m256d x, __m256d y, __m256d z, double, avx_tag) {
+		return _mm256_fnmadd_pd(x, y, z);
+	}
+	static inline __m256 fnms(__m256 x, __m256 y, __m256 z, float, avx_tag) {
+		return _mm256_fnmsub_ps(x, y, z);
+	}
+	static inline __m256d fnms(__m256d x, __m256d y, __m256d z, double, avx_tag) {
+		return _mm256_fnmsub_pd(x, y, z);
+	}
+#else
+	static inline __m256 fma(__m256 x, __m256 y, __m256 z, float, avx_tag) {
+		return _mm256_add_ps(_mm256_mul_ps(x, y), z);
+	}
+	static inline __m256d fma(__m256d x, __m256d y, __m256d z, double, avx_tag) {
+		return _mm256_add_pd(_mm256_mul_pd(x, y), z);
+	}
+	static inline __m256 fms(__m256 x, __m256 y, __m256 z, float, avx_tag) {
+		return _mm256_sub_ps(_mm256_mul_ps(x, y), z);
+	}
+	static inline __m256d fms(__m256d x, __m256d y, __m256d z, double, avx_tag) {
+		return _mm256_sub_pd(_mm256_mul_pd(x, y), z);
+	}
+	static inline __m256 fnma(__m256 x, __m256 y, __m256 z, float, avx_tag) {
+		return _mm256_sub_ps(z, _mm256_mul_ps(x, y));
+	}
+	static inline __m256d fnma(__m256d x, __m256d y, __m256d z, double, avx_tag) {
+		return _mm256_sub_pd(z, _mm256_mul_pd(x, y));
+	}
+	static inline __m256 fnms(__m256 x, __m256 y, __m256 z, float, avx_tag) {
+		return _mm256_sub_ps(_mm256_sub_ps(_mm256_setzero_ps(), _mm256_mul_ps(x, y)), z);
+	}
+	static inline __m256d fnms(__m256d x, __m256d y, __m256d z, double, avx_tag) {
+		return _mm256_sub_pd(_mm256_sub_pd(_mm256_setzero_pd(), _mm256_mul_pd(x, y)), z);
+	}
+#endif
 	/*************************************************************************/
 	static inline __m256 max(__m256 x, __m256 y, float, avx_tag) {
 		return _mm256_max_ps(x, y);
@@ -112,6 +232,49 @@ namespace scimd {
 		return _mm256_cmp_pd(x, y, _CMP_GE_OQ);
 	}
 	/*************************************************************************/
+	/**
+	 * 	Horizontal reductions
+	 *
+	 * 	These use a shuffle tree: fold the high half onto the low half
+	 * 	until a single lane remains.
+	 */
+	static inline float reduce_add(__m256 x, float, avx_tag) {
+		const __m128 v = _mm_add_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+		const __m128 t = _mm_add_ps(v, _mm_movehl_ps(v, v));
+		return _mm_cvtss_f32(_mm_add_ss(t, _mm_shuffle_ps(t, t, 0x55)));
+	}
+	static inline double reduce_add(__m256d x, double, avx_tag) {
+		const __m128d v = _mm_add_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+		return _mm_cvtsd_f64(_mm_add_sd(v, _mm_unpackhi_pd(v, v)));
+	}
+	static inline float reduce_mul(__m256 x, float, avx_tag) {
+		const __m128 v = _mm_mul_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+		const __m128 t = _mm_mul_ps(v, _mm_movehl_ps(v, v));
+		return _mm_cvtss_f32(_mm_mul_ss(t, _mm_shuffle_ps(t, t, 0x55)));
+	}
+	static inline double reduce_mul(__m256d x, double, avx_tag) {
+		const __m128d v = _mm_mul_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+		return _mm_cvtsd_f64(_mm_mul_sd(v, _mm_unpackhi_pd(v, v)));
+	}
+	static inline float reduce_min(__m256 x, float, avx_tag) {
+		const __m128 v = _mm_min_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+		const __m128 t = _mm_min_ps(v, _mm_movehl_ps(v, v));
+		return _mm_cvtss_f32(_mm_min_ss(t, _mm_shuffle_ps(t, t, 0x55)));
+	}
+	static inline double reduce_min(__m256d x, double, avx_tag) {
+		const __m128d v = _mm_min_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+		return _mm_cvtsd_f64(_mm_min_sd(v, _mm_unpackhi_pd(v, v)));
+	}
+	static inline float reduce_max(__m256 x, float, avx_tag) {
+		const __m128 v = _mm_max_ps(_mm256_castps256_ps128(x), _mm256_extractf128_ps(x, 1));
+		const __m128 t = _mm_max_ps(v, _mm_movehl_ps(v, v));
+		return _mm_cvtss_f32(_mm_max_ss(t, _mm_shuffle_ps(t, t, 0x55)));
+	}
+	static inline double reduce_max(__m256d x, double, avx_tag) {
+		const __m128d v = _mm_max_pd(_mm256_castpd256_pd128(x), _mm256_extractf128_pd(x, 1));
+		return _mm_cvtsd_f64(_mm_max_sd(v, _mm_unpackhi_pd(v, v)));
+	}
+	/*************************************************************************/
 	static inline bool logical_all(__m256 x, float, avx_tag) {
 		return _mm256_movemask_ps(x) == mask_t<float>::value;
 	}
@@ -124,6 +287,73 @@ namespace scimd {
 	static inline bool logical_none(__m256d x, double, avx_tag) {
 		return _mm256_movemask_pd(x) == 0;
 	}
+	static inline size_t logical_count(__m256 x, float, avx_tag) {
+		return static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(_mm256_movemask_ps(x))));
+	}
+	static inline size_t logical_count(__m256d x, double, avx_tag) {
+		return static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(_mm256_movemask_pd(x))));
+	}
+	static inline __m256 logical_and(__m256 x, __m256 y, float, avx_tag) {
+		return _mm256_and_ps(x, y);
+	}
+	static inline __m256d logical_and(__m256d x, __m256d y, double, avx_tag) {
+		return _mm256_and_pd(x, y);
+	}
+	static inline __m256 logical_or(__m256 x, __m256 y, float, avx_tag) {
+		return _mm256_or_ps(x, y);
+	}
+	static inline __m256d logical_or(__m256d x, __m256d y, double, avx_tag) {
+		return _mm256_or_pd(x, y);
+	}
+	static inline __m256 logical_xor(__m256 x, __m256 y, float, avx_tag) {
+		return _mm256_xor_ps(x, y);
+	}
+	static inline __m256d logical_xor(__m256d x, __m256d y, double, avx_tag) {
+		return _mm256_xor_pd(x, y);
+	}
+	static inline __m256 logical_not(__m256 x, float, avx_tag) {
+		return _mm256_xor_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(-1)));
+	}
+	static inline __m256d logical_not(__m256d x, double, avx_tag) {
+		return _mm256_xor_pd(x, _mm256_castsi256_pd(_mm256_set1_epi32(-1)));
+	}
+	/**
+	 * 	Bit i of to_bits is lane i of the mask. AVX has no 256-bit integer
+	 * 	compares, so from_bits builds each half with SSE.
+	 */
+	static inline uint32_t to_bits(__m256 x, float, avx_tag) {
+		return static_cast<uint32_t>(_mm256_movemask_ps(x));
+	}
+	static inline uint32_t to_bits(__m256d x, double, avx_tag) {
+		return static_cast<uint32_t>(_mm256_movemask_pd(x));
+	}
+#ifdef __AVX2__
+	static inline __m256 from_bits(uint32_t bits, float, avx_tag) {
+		const __m256i lanes = _mm256_setr_epi32(1, 2, 4, 8, 16, 32, 64, 128);
+		const __m256i x = _mm256_and_si256(_mm256_set1_epi32(static_cast<int>(bits)), lanes);
+		return _mm256_castsi256_ps(_mm256_cmpeq_epi32(x, lanes));
+	}
+	static inline __m256d from_bits(uint32_t bits, double, avx_tag) {
+		const __m256i lanes = _mm256_setr_epi64x(1, 2, 4, 8);
+		const __m256i x = _mm256_and_si256(_mm256_set1_epi64x(bits), lanes);
+		return _mm256_castsi256_pd(_mm256_cmpeq_epi64(x, lanes));
+	}
+#else
+	static inline __m256 from_bits(uint32_t bits, float, avx_tag) {
+		const __m128i lanes = _mm_setr_epi32(1, 2, 4, 8);
+		const __m128i lo = _mm_and_si128(_mm_set1_epi32(static_cast<int>(bits)), lanes);
+		const __m128i hi = _mm_and_si128(_mm_set1_epi32(static_cast<int>(bits >> 4)), lanes);
+		return _mm256_castsi256_ps(_mm256_insertf128_si256(
+			_mm256_castsi128_si256(_mm_cmpeq_epi32(lo, lanes)), _mm_cmpeq_epi32(hi, lanes), 1));
+	}
+	static inline __m256d from_bits(uint32_t bits, double, avx_tag) {
+		const __m128i lanes = _mm_set_epi64x(2, 1);
+		const __m128i lo = _mm_and_si128(_mm_set1_epi64x(bits), lanes);
+		const __m128i hi = _mm_and_si128(_mm_set1_epi64x(bits >> 2), lanes);
+		return _mm256_castsi256_pd(_mm256_insertf128_si256(
+			_mm256_castsi128_si256(_mm_cmpeq_epi64(lo, lanes)), _mm_cmpeq_epi64(hi, lanes), 1));
+	}
+#endif
 	/*************************************************************************/
 	static inline void store(float *p, __m256 x, float, avx_tag, memory::unaligned) {
 		_mm256_storeu_ps(p, x);
@@ -137,6 +367,12 @@ namespace scimd {
 	static inline void store(double *p, __m256d x, double, avx_tag, memory::aligned) {
 		_mm256_store_pd(p, x);
 	}
+	static inline void store(float *p, __m256 x, float, avx_tag, memory::streaming) {
+		_mm256_stream_ps(p, x);
+	}
+	static inline void store(double *p, __m256d x, double, avx_tag, memory::streaming) {
+		_mm256_stream_pd(p, x);
+	}
 	static inline __m256 load(float const* p, float, avx_tag, memory::unaligned) {
 		return _mm256_loadu_ps(p);
 	}
@@ -149,12 +385,218 @@ namespace scimd {
 	static inline __m256d load(double const* p, double, avx_tag, memory::aligned) {
 		return _mm256_load_pd(p);
 	}
+	/**
+	 * 	Partial loads and stores touch only the first n elements. Lanes
+	 * 	beyond n are loaded as zero.
+	 */
+	static inline __m256 load_n(float const* p, size_t n, float, avx_tag) {
+		const __m256i mask = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(tail_mask32 + 8 - n));
+		return _mm256_maskload_ps(p, mask);
+	}
+	static inline __m256d load_n(double const* p, size_t n, double, avx_tag) {
+		const __m256i mask = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(tail_mask64 + 4 - n));
+		return _mm256_maskload_pd(p, mask);
+	}
+	static inline void store_n(float *p, size_t n, __m256 x, float, avx_tag) {
+		const __m256i mask = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(tail_mask32 + 8 - n));
+		_mm256_maskstore_ps(p, mask, x);
+	}
+	static inline void store_n(double *p, size_t n, __m256d x, double, avx_tag) {
+		const __m256i mask = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(tail_mask64 + 4 - n));
+		_mm256_maskstore_pd(p, mask, x);
+	}
+	/**
+	 * 	Gathers are native with AVX2 and emulated otherwise. AVX has no
+	 * 	scatter, so it is always emulated. Overlapping scatter indices are
+	 * 	written in lane order (the last lane wins), as on AVX-512.
+	 */
+	static inline __m256i load_index(int32_t const* p, float, avx_tag) {
+		return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+	}
+	static inline __m128i load_index(int32_t const* p, double, avx_tag) {
+		return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+	}
+	static inline void store_index(int32_t *p, __m256i x, float, avx_tag) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+	}
+	static inline void store_index(int32_t *p, __m128i x, double, avx_tag) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(p), x);
+	}
+	static inline __m256i load_index(int64_t const* p, double, avx_tag) {
+		return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+	}
+	static inline void store_index(int64_t *p, __m256i x, double, avx_tag) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+	}
+#ifdef __AVX2__
+	static inline __m256 gather(float const* base, __m256i idx, float, int32_t, avx_tag) {
+		return _mm256_i32gather_ps(base, idx, sizeof(float));
+	}
+	static inline __m256d gather(double const* base, __m128i idx, double, int32_t, avx_tag) {
+		return _mm256_i32gather_pd(base, idx, sizeof(double));
+	}
+	static inline __m256d gather(double const* base, __m256i idx, double, int64_t, avx_tag) {
+		return _mm256_i64gather_pd(base, idx, sizeof(double));
+	}
+#else
+	static inline __m256 gather(float const* base, __m256i idx, float, int32_t, avx_tag) {
+		alignas(32) int32_t i[8];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(i), idx);
+		return _mm256_setr_ps(base[i[0]], base[i[1]], base[i[2]], base[i[3]],
+							  base[i[4]], base[i[5]], base[i[6]], base[i[7]]);
+	}
+	static inline __m256d gather(double const* base, __m128i idx, double, int32_t, avx_tag) {
+		alignas(16) int32_t i[4];
+		_mm_store_si128(reinterpret_cast<__m128i*>(i), idx);
+		return _mm256_setr_pd(base[i[0]], base[i[1]], base[i[2]], base[i[3]]);
+	}
+	static inline __m256d gather(double const* base, __m256i idx, double, int64_t, avx_tag) {
+		alignas(32) int64_t i[4];
+		_mm256_store_si256(reinterpret_cast<__m256i*>(i), idx);
+		return _mm256_setr_pd(base[i[0]], base[i[1]], base[i[2]], base[i[3]]);
+	}
+#endif
+	static inline void scatter(float *base, __m256i idx, __m256 x, float, int32_t, avx_tag) {
+		alignas(32) float tmp[8];
+		alignas(32) int32_t i[8];
+		_mm256_store_ps(tmp, x);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(i), idx);
+		for (int k = 0; k < 8; k++) {
+			base[i[k]] = tmp[k];
+		}
+	}
+	static inline void scatter(double *base, __m128i idx, __m256d x, double, int32_t, avx_tag) {
+		alignas(32) double tmp[4];
+		alignas(16) int32_t i[4];
+		_mm256_store_pd(tmp, x);
+		_mm_store_si128(reinterpret_cast<__m128i*>(i), idx);
+		for (int k = 0; k < 4; k++) {
+			base[i[k]] = tmp[k];
+		}
+	}
+	static inline void scatter(double *base, __m256i idx, __m256d x, double, int64_t, avx_tag) {
+		alignas(32) double tmp[4];
+		alignas(32) int64_t i[4];
+		_mm256_store_pd(tmp, x);
+		_mm256_store_si256(reinterpret_cast<__m256i*>(i), idx);
+		for (int k = 0; k < 4; k++) {
+			base[i[k]] = tmp[k];
+		}
+	}
 	static inline __m256 blend(__m256 x, __m256 y, __m256 mask, float, avx_tag) {
 		return _mm256_blendv_ps(x, y, mask);
 	}
 	static inline __m256d blend(__m256d x, __m256d y, __m256d mask, double, avx_tag) {
 		return _mm256_blendv_pd(x, y, mask);
 	}
+	/**
+	 * 	Compress moves the lanes selected by the mask to the front, in order.
+	 * 	The remaining lanes are unspecified. AVX2 permutes across the whole
+	 * 	register with a lookup table. AVX can only permute within each half,
+	 * 	so it is emulated one lane at a time.
+	 */
+#ifdef __AVX2__
+	static inline __m256i compress_index(uint32_t nibbles) {
+		return _mm256_srlv_epi32(_mm256_set1_epi32(static_cast<int>(nibbles)), _mm256_setr_epi32(0, 4, 8, 12, 16, 20, 24, 28));
+	}
+	static inline __m256 compress(__m256 x, __m256 mask, float, avx_tag) {
+		return _mm256_permutevar8x32_ps(x, compress_index(compress_lut32[_mm256_movemask_ps(mask)]));
+	}
+	static inline __m256d compress(__m256d x, __m256d mask, double, avx_tag) {
+		const __m256i idx = compress_index(compress_lut64[_mm256_movemask_pd(mask)]);
+		return _mm256_castps_pd(_mm256_permutevar8x32_ps(_mm256_castpd_ps(x), idx));
+	}
+#else
+	static inline __m256 compress(__m256 x, __m256 mask, float, avx_tag) {
+		alignas(32) float tmp[8];
+		_mm256_store_ps(tmp, x);
+		const int m = _mm256_movemask_ps(mask);
+		int k = 0;
+		for (int i = 0; i < 8; i++) {
+			if (m & (1 << i)) {
+				tmp[k++] = tmp[i];
+			}
+		}
+		return _mm256_load_ps(tmp);
+	}
+	static inline __m256d compress(__m256d x, __m256d mask, double, avx_tag) {
+		alignas(32) double tmp[4];
+		_mm256_store_pd(tmp, x);
+		const int m = _mm256_movemask_pd(mask);
+		int k = 0;
+		for (int i = 0; i < 4; i++) {
+			if (m & (1 << i)) {
+				tmp[k++] = tmp[i];
+			}
+		}
+		return _mm256_load_pd(tmp);
+	}
+#endif
+	/*************************************************************************/
+	/**
+	 * 	Exponent manipulation (used by the transcendental functions)
+	 *
+	 * 	round:   round to nearest, ties to even
+	 * 	ldexp:   x * 2^n for integral n (the full range, including subnormal results)
+	 * 	getexp:  floor(log2(x))
+	 * 	getmant: x * 2^-getexp(x), in [1, 2)
+	 *
+	 * 	getexp and getmant assume x is positive and normal.
+	 *
+	 * 	ldexp builds 2^n in two halves so that each is a normal number.
+	 * 	Only AVX (not AVX2) instructions are used, so the exponent fields
+	 * 	are moved through the float<->int32 conversions.
+	 */
+	static inline __m256 round(__m256 x, float, avx_tag) {
+		return _mm256_round_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	}
+	static inline __m256d round(__m256d x, double, avx_tag) {
+		return _mm256_round_pd(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	}
+	static inline __m256 ldexp(__m256 x, __m256 n, float, avx_tag) {
+		n = _mm256_min_ps(_mm256_max_ps(n, _mm256_set1_ps(-252.0f)), _mm256_set1_ps(254.0f));
+		const __m256 n1 = _mm256_floor_ps(_mm256_mul_ps(n, _mm256_set1_ps(0.5f)));
+		const __m256 n2 = _mm256_sub_ps(n, n1);
+		// (n + 127) * 2^23 is exact, so its integer conversion is the bit pattern of 2^n
+		const __m256 bias = _mm256_set1_ps(127.0f), shift = _mm256_set1_ps(8388608.0f);
+		const __m256i e1 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_add_ps(n1, bias), shift));
+		const __m256i e2 = _mm256_cvtps_epi32(_mm256_mul_ps(_mm256_add_ps(n2, bias), shift));
+		return _mm256_mul_ps(_mm256_mul_ps(x, _mm256_castsi256_ps(e1)), _mm256_castsi256_ps(e2));
+	}
+	static inline __m256d ldexp(__m256d x, __m256d n, double, avx_tag) {
+		n = _mm256_min_pd(_mm256_max_pd(n, _mm256_set1_pd(-2044.0)), _mm256_set1_pd(2046.0));
+		const __m256d n1 = _mm256_floor_pd(_mm256_mul_pd(n, _mm256_set1_pd(0.5)));
+		const __m256d n2 = _mm256_sub_pd(n, n1);
+		const __m256d bias = _mm256_set1_pd(1023.0);
+		const __m128i zero = _mm_setzero_si128();
+		// Place the biased exponent in the high dword of each 64-bit lane
+		const __m128i e1 = _mm_slli_epi32(_mm256_cvtpd_epi32(_mm256_add_pd(n1, bias)), 20);
+		const __m128i e2 = _mm_slli_epi32(_mm256_cvtpd_epi32(_mm256_add_pd(n2, bias)), 20);
+		const __m256i p1 = _mm256_insertf128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi32(zero, e1)), _mm_unpackhi_epi32(zero, e1), 1);
+		const __m256i p2 = _mm256_insertf128_si256(_mm256_castsi128_si256(_mm_unpacklo_epi32(zero, e2)), _mm_unpackhi_epi32(zero, e2), 1);
+		return _mm256_mul_pd(_mm256_mul_pd(x, _mm256_castsi256_pd(p1)), _mm256_castsi256_pd(p2));
+	}
+	static inline __m256 getexp(__m256 x, float, avx_tag) {
+		// The exponent field as an integer is E * 2^23, which converts exactly
+		const __m256 field = _mm256_and_ps(x, _mm256_castsi256_ps(_mm256_set1_epi32(0x7f800000)));
+		const __m256 e = _mm256_cvtepi32_ps(_mm256_castps_si256(field));
+		return _mm256_sub_ps(_mm256_mul_ps(e, _mm256_set1_ps(1.0f / 8388608.0f)), _mm256_set1_ps(127.0f));
+	}
+	static inline __m256d getexp(__m256d x, double, avx_tag) {
+		// Collect the high dword (E * 2^20) of each lane
+		const __m256 f = _mm256_castpd_ps(x);
+		const __m128 hi = _mm_shuffle_ps(_mm256_castps256_ps128(f), _mm256_extractf128_ps(f, 1), _MM_SHUFFLE(3, 1, 3, 1));
+		const __m128i field = _mm_srli_epi32(_mm_castps_si128(hi), 20);
+		return _mm256_cvtepi32_pd(_mm_sub_epi32(field, _mm_set1_epi32(1023)));
+	}
+	static inline __m256 getmant(__m256 x, float, avx_tag) {
+		const __m256 mask = _mm256_castsi256_ps(_mm256_set1_epi32(0x007fffff));
+		return _mm256_or_ps(_mm256_and_ps(x, mask), _mm256_set1_ps(1.0f));
+	}
+	static inline __m256d getmant(__m256d x, double, avx_tag) {
+		const __m256d mask = _mm256_castsi256_pd(_mm256_set1_epi64x(0x000fffffffffffffLL));
+		return _mm256_or_pd(_mm256_and_pd(x, mask), _mm256_set1_pd(1.0));
+	}
 	/*************************************************************************/
 	static inline __m256 sqrt(__m256 x, float, avx_tag) {
 		return _mm256_sqrt_ps(x);
@@ -170,8 +612,19 @@ namespace scimd {
 		 */
 		const __m256 three = _mm256_set1_ps(3.0f), half = _mm256_set1_ps(0.5f);
 		const __m256 rsrt = _mm256_rsqrt_ps(x);
-		const __m256 muls = _mm256_mul_ps(_mm256_mul_ps(x, rsrt), rsrt);
-		return _mm256_mul_ps(_mm256_mul_ps(half, rsrt), _mm256_sub_ps(three, muls));
+		const __m256 corr = fnma(_mm256_mul_ps(x, rsrt), rsrt, three, float{}, avx_tag{});
+		return _mm256_mul_ps(_mm256_mul_ps(half, rsrt), corr);
+	}
+	/**
+	 * 	The double-precision rsqrt and rcp refine a single-precision estimate,
+	 * 	which is only valid where the argument and its result are normal
+	 * 	floats. Check that every lane of `x` is in [2^-126, 2^126]; this is
+	 * 	false for 0, inf, and NaN.
+	 */
+	static inline bool in_float_range(__m256d x) {
+		const __m256d lo = _mm256_set1_pd(static_cast<double>(std::numeric_limits<float>::min()));
+		const __m256d hi = _mm256_set1_pd(1.0 / static_cast<double>(std::numeric_limits<float>::min()));
+		return _mm256_movemask_pd(_mm256_and_pd(_mm256_cmp_pd(x, lo, _CMP_GE_OQ), _mm256_cmp_pd(x, hi, _CMP_LE_OQ))) == 0xF;
 	}
 	static inline __m256d rsqrt(__m256d a, double, avx_tag) {
 		/**
@@ -183,16 +636,50 @@ namespace scimd {
 		* 	The speedup compared to using sqrt+div varies by CPU architecture, but
 		* 	is between 10% (Skylake) and 3x (Sandybridge) faster.
 		*/
+		if (!in_float_range(a)) {
+			return _mm256_div_pd(_mm256_set1_pd(1.0), _mm256_sqrt_pd(a));
+		}
 		__m256d one = _mm256_set1_pd(1.0), c1 = _mm256_set1_pd(1.0/2.0),
 				c2 = _mm256_set1_pd(3.0/8.0), c3 = _mm256_set1_pd(15.0/48.0),
 				c4 = _mm256_set1_pd(105.0/384.0);
 		__m256d x = _mm256_cvtps_pd(_mm_rsqrt_ps(_mm256_cvtpd_ps(a)));
-		__m256d r = _mm256_sub_pd(one, _mm256_mul_pd(_mm256_mul_pd(a, x), x));
+		__m256d r = fnma(_mm256_mul_pd(a, x), x, one, double{}, avx_tag{});
 		__m256d r2 = _mm256_mul_pd(r, r);
-		__m256d t1 = _mm256_add_pd(_mm256_mul_pd(c2, r), c1);
-		__m256d t3 = _mm256_add_pd(_mm256_mul_pd(c4, r), c3);
-		__m256d poly = _mm256_add_pd(_mm256_mul_pd(r2, t3), t1);
-		return _mm256_add_pd(_mm256_mul_pd(_mm256_mul_pd(x, r), poly), x);
+		__m256d t1 = fma(c2, r, c1, double{}, avx_tag{});
+		__m256d t3 = fma(c4, r, c3, double{}, avx_tag{});
+		__m256d poly = fma(r2, t3, t1, double{}, avx_tag{});
+		return fma(_mm256_mul_pd(x, r), poly, x, double{}, avx_tag{});
+	}
+	static inline __m256 rsqrt(__m256 x, float, avx_tag, precision::fast) {
+		return _mm256_rsqrt_ps(x);
+	}
+	static inline __m256d rsqrt(__m256d x, double, avx_tag, precision::fast) {
+		return _mm256_cvtps_pd(_mm_rsqrt_ps(_mm256_cvtpd_ps(x)));
+	}
+	static inline __m256 rcp(__m256 a, float, avx_tag) {
+		// One Newton-Raphson iteration brings the precision to ~23 bits
+		const __m256 x = _mm256_rcp_ps(a);
+		return fma(x, fnma(a, x, _mm256_set1_ps(1.0f), float{}, avx_tag{}), x, float{}, avx_tag{});
+	}
+	static inline __m256d rcp(__m256d a, double, avx_tag) {
+		/**
+		 * 	With r = 1 - a*x, 1/a = x*(1 + r + r^2 + ...). Stopping at r^4
+		 * 	leaves an error of ~2^-58.
+		 */
+		const __m256d one = _mm256_set1_pd(1.0);
+		if (!in_float_range(_mm256_andnot_pd(_mm256_set1_pd(-0.0), a))) {
+			return _mm256_div_pd(one, a);
+		}
+		const __m256d x = _mm256_cvtps_pd(_mm_rcp_ps(_mm256_cvtpd_ps(a)));
+		const __m256d r = fnma(a, x, one, double{}, avx_tag{});
+		const __m256d poly = _mm256_mul_pd(_mm256_add_pd(one, r), fma(r, r, one, double{}, avx_tag{}));
+		return fma(_mm256_mul_pd(x, r), poly, x, double{}, avx_tag{});
+	}
+	static inline __m256 rcp(__m256 x, float, avx_tag, precision::fast) {
+		return _mm256_rcp_ps(x);
+	}
+	static inline __m256d rcp(__m256d x, double, avx_tag, precision::fast) {
+		return _mm256_cvtps_pd(_mm_rcp_ps(_mm256_cvtpd_ps(x)));
 	}
 
-};
+}}
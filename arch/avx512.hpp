@@ -4,12 +4,14 @@
 #include <cstdint>
 #include "traits.hpp"
 #include "memory.hpp"
+#include "precision.hpp"
 
-namespace scimd {
+namespace scimd { inline namespace SCIMD_ISA_NAMESPACE {
 
 	struct avx512_tag {};
 
 	template <> struct is_avx512<avx512_tag> : std::true_type {};
+	template <> struct has_fma<avx512_tag> : std::true_type {};
 
 	struct simd_category { using type = avx512_tag; };
 
@@ -19,6 +21,10 @@ namespace scimd {
 	template <> struct bool_type<float> { using type = __mmask16; };
 	template <> struct bool_type<double> { using type = __mmask8; };
 
+	template <> struct index_type<float> { using type = __m512i; };
+	template <> struct index_type<double> { using type = __m256i; };
+	template <> struct index_type<double, int64_t> { using type = __m512i; };
+
 	namespace {
 		template <typename T>
 		struct mask_t {};
@@ -74,6 +80,39 @@ namespace scimd {
 		return _mm512_div_pd(x, y);
 	}
 	/*************************************************************************/
+	/**
+	 * 	Fused multiply-add family
+	 *
+	 * 	fma:  x*y + z	fms:  x*y - z
+	 * 	fnma: z - x*y	fnms: -(x*y) - z
+	 *
+	 * 	FMA is part of the AVX512F foundation, so there is no fallback.
+	 */
+	static inline __m512 fma(__m512 x, __m512 y, __m512 z, float, avx512_tag) {
+		return _mm512_fmadd_ps(x, y, z);
+	}
+	static inline __m512d fma(__m512d x, __m512d y, __m512d z, double, avx512_tag) {
+		return _mm512_fmadd_pd(x, y, z);
+	}
+	static inline __m512 fms(__m512 x, __m512 y, __m512 z, float, avx512_tag) {
+		return _mm512_fmsub_ps(x, y, z);
+	}
+	static inline __m512d fms(__m512d x, __m512d y, __m512d z, double, avx512_tag) {
+		return _mm512_fmsub_pd(x, y, z);
+	}
+	static inline __m512 fnma(__m512 x, __m512 y, __m512 z, float, avx512_tag) {
+		return _mm512_fnmadd_ps(x, y, z);
+	}
+	static inline __m512d fnma(__m512d x, __m512d y, __m512d z, double, avx512_tag) {
+		return _mm512_fnmadd_pd(x, y, z);
+	}
+	static inline __m512 fnms(__m512 x, __m512 y, __m512 z, float, avx512_tag) {
+		return _mm512_fnmsub_ps(x, y, z);
+	}
+	static inline __m512d fnms(__m512d x, __m512d y, __m512d z, double, avx512_tag) {
+		return _mm512_fnmsub_pd(x, y, z);
+	}
+	/*************************************************************************/
 	static inline __m512 max(__m512 x, __m512 y, float, avx512_tag) {
 		return _mm512_max_ps(x, y);
 	}
@@ -138,6 +177,31 @@ namespace scimd {
 		return _mm512_mask_cmp_pd_mask(mask_t<double>::value, x, y, _CMP_GE_OQ);
 	}
 	/*************************************************************************/
+	static inline float reduce_add(__m512 x, float, avx512_tag) {
+		return _mm512_reduce_add_ps(x);
+	}
+	static inline double reduce_add(__m512d x, double, avx512_tag) {
+		return _mm512_reduce_add_pd(x);
+	}
+	static inline float reduce_mul(__m512 x, float, avx512_tag) {
+		return _mm512_reduce_mul_ps(x);
+	}
+	static inline double reduce_mul(__m512d x, double, avx512_tag) {
+		return _mm512_reduce_mul_pd(x);
+	}
+	static inline float reduce_min(__m512 x, float, avx512_tag) {
+		return _mm512_reduce_min_ps(x);
+	}
+	static inline double reduce_min(__m512d x, double, avx512_tag) {
+		return _mm512_reduce_min_pd(x);
+	}
+	static inline float reduce_max(__m512 x, float, avx512_tag) {
+		return _mm512_reduce_max_ps(x);
+	}
+	static inline double reduce_max(__m512d x, double, avx512_tag) {
+		return _mm512_reduce_max_pd(x);
+	}
+	/*************************************************************************/
 	static inline bool logical_all(__mmask16 x, float, avx512_tag) {
 		return _mm512_kand(mask_t<float>::value, x) == mask_t<float>::value;
 	}
@@ -150,6 +214,51 @@ namespace scimd {
 	static inline bool logical_none(__mmask8 x, double, avx512_tag) {
 		return _mm512_kand(mask_t<double>::value, x) == 0;
 	}
+	static inline size_t logical_count(__mmask16 x, float, avx512_tag) {
+		return static_cast<size_t>(__builtin_popcount(x));
+	}
+	static inline size_t logical_count(__mmask8 x, double, avx512_tag) {
+		return static_cast<size_t>(__builtin_popcount(x));
+	}
+	static inline __mmask16 logical_and(__mmask16 x, __mmask16 y, float, avx512_tag) {
+		return _mm512_kand(x, y);
+	}
+	static inline __mmask8 logical_and(__mmask8 x, __mmask8 y, double, avx512_tag) {
+		return static_cast<__mmask8>(_mm512_kand(x, y));
+	}
+	static inline __mmask16 logical_or(__mmask16 x, __mmask16 y, float, avx512_tag) {
+		return _mm512_kor(x, y);
+	}
+	static inline __mmask8 logical_or(__mmask8 x, __mmask8 y, double, avx512_tag) {
+		return static_cast<__mmask8>(_mm512_kor(x, y));
+	}
+	static inline __mmask16 logical_xor(__mmask16 x, __mmask16 y, float, avx512_tag) {
+		return _mm512_kxor(x, y);
+	}
+	static inline __mmask8 logical_xor(__mmask8 x, __mmask8 y, double, avx512_tag) {
+		return static_cast<__mmask8>(_mm512_kxor(x, y));
+	}
+	static inline __mmask16 logical_not(__mmask16 x, float, avx512_tag) {
+		return _mm512_knot(x);
+	}
+	static inline __mmask8 logical_not(__mmask8 x, double, avx512_tag) {
+		return static_cast<__mmask8>(_mm512_knot(x));
+	}
+	/**
+	 * 	The masks already are the bits of their lanes.
+	 */
+	static inline uint32_t to_bits(__mmask16 x, float, avx512_tag) {
+		return x;
+	}
+	static inline uint32_t to_bits(__mmask8 x, double, avx512_tag) {
+		return x;
+	}
+	static inline __mmask16 from_bits(uint32_t bits, float, avx512_tag) {
+		return static_cast<__mmask16>(bits);
+	}
+	static inline __mmask8 from_bits(uint32_t bits, double, avx512_tag) {
+		return static_cast<__mmask8>(bits);
+	}
 	/*************************************************************************/
 	static inline void store(float *p, __m512 x, float, avx512_tag, memory::unaligned) {
 		_mm512_storeu_ps(p, x);
@@ -163,6 +272,12 @@ namespace scimd {
 	static inline void store(double *p, __m512d x, double, avx512_tag, memory::aligned) {
 		_mm512_store_pd(p, x);
 	}
+	static inline void store(float *p, __m512 x, float, avx512_tag, memory::streaming) {
+		_mm512_stream_ps(p, x);
+	}
+	static inline void store(double *p, __m512d x, double, avx512_tag, memory::streaming) {
+		_mm512_stream_pd(p, x);
+	}
 	static inline __m512 load(float const* p, float, avx512_tag, memory::unaligned) {
 		return _mm512_loadu_ps(p);
 	}
@@ -175,12 +290,117 @@ namespace scimd {
 	static inline __m512d load(double const* p, double, avx512_tag, memory::aligned) {
 		return _mm512_load_pd(p);
 	}
+	/**
+	 * 	Partial loads and stores touch only the first n elements. Lanes
+	 * 	beyond n are loaded as zero. Masked-off lanes never fault.
+	 */
+	static inline __m512 load_n(float const* p, size_t n, float, avx512_tag) {
+		return _mm512_maskz_loadu_ps(static_cast<__mmask16>((1u << n) - 1), p);
+	}
+	static inline __m512d load_n(double const* p, size_t n, double, avx512_tag) {
+		return _mm512_maskz_loadu_pd(static_cast<__mmask8>((1u << n) - 1), p);
+	}
+	static inline void store_n(float *p, size_t n, __m512 x, float, avx512_tag) {
+		_mm512_mask_storeu_ps(p, static_cast<__mmask16>((1u << n) - 1), x);
+	}
+	static inline void store_n(double *p, size_t n, __m512d x, double, avx512_tag) {
+		_mm512_mask_storeu_pd(p, static_cast<__mmask8>((1u << n) - 1), x);
+	}
+	static inline __m512i load_index(int32_t const* p, float, avx512_tag) {
+		return _mm512_loadu_si512(p);
+	}
+	static inline __m256i load_index(int32_t const* p, double, avx512_tag) {
+		return _mm256_loadu_si256(reinterpret_cast<__m256i const*>(p));
+	}
+	static inline void store_index(int32_t *p, __m512i x, float, avx512_tag) {
+		_mm512_storeu_si512(p, x);
+	}
+	static inline void store_index(int32_t *p, __m256i x, double, avx512_tag) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(p), x);
+	}
+	static inline __m512i load_index(int64_t const* p, double, avx512_tag) {
+		return _mm512_loadu_si512(p);
+	}
+	static inline void store_index(int64_t *p, __m512i x, double, avx512_tag) {
+		_mm512_storeu_si512(p, x);
+	}
+	static inline __m512 gather(float const* base, __m512i idx, float, int32_t, avx512_tag) {
+		return _mm512_i32gather_ps(idx, base, sizeof(float));
+	}
+	static inline __m512d gather(double const* base, __m256i idx, double, int32_t, avx512_tag) {
+		return _mm512_i32gather_pd(idx, base, sizeof(double));
+	}
+	static inline __m512d gather(double const* base, __m512i idx, double, int64_t, avx512_tag) {
+		return _mm512_i64gather_pd(idx, base, sizeof(double));
+	}
+	static inline void scatter(float *base, __m512i idx, __m512 x, float, int32_t, avx512_tag) {
+		_mm512_i32scatter_ps(base, idx, x, sizeof(float));
+	}
+	static inline void scatter(double *base, __m256i idx, __m512d x, double, int32_t, avx512_tag) {
+		_mm512_i32scatter_pd(base, idx, x, sizeof(double));
+	}
+	static inline void scatter(double *base, __m512i idx, __m512d x, double, int64_t, avx512_tag) {
+		_mm512_i64scatter_pd(base, idx, x, sizeof(double));
+	}
 	static inline __m512 blend(__m512 x, __m512 y, __mmask16 mask, float, avx512_tag) {
 		return _mm512_mask_blend_ps(mask, x, y);
 	}
 	static inline __m512d blend(__m512d x, __m512d y, __mmask8 mask, double, avx512_tag) {
 		return _mm512_mask_blend_pd(mask, x, y);
 	}
+	/**
+	 * 	Compress moves the lanes selected by the mask to the front, in order.
+	 * 	The remaining lanes are zero.
+	 */
+	static inline __m512 compress(__m512 x, __mmask16 mask, float, avx512_tag) {
+		return _mm512_maskz_compress_ps(mask, x);
+	}
+	static inline __m512d compress(__m512d x, __mmask8 mask, double, avx512_tag) {
+		return _mm512_maskz_compress_pd(mask, x);
+	}
+	static inline size_t compress_store(float *p, __m512 x, __mmask16 mask, float, avx512_tag) {
+		_mm512_mask_compressstoreu_ps(p, mask, x);
+		return logical_count(mask, float{}, avx512_tag{});
+	}
+	static inline size_t compress_store(double *p, __m512d x, __mmask8 mask, double, avx512_tag) {
+		_mm512_mask_compressstoreu_pd(p, mask, x);
+		return logical_count(mask, double{}, avx512_tag{});
+	}
+	/*************************************************************************/
+	/**
+	 * 	Exponent manipulation (used by the transcendental functions)
+	 *
+	 * 	round:   round to nearest, ties to even
+	 * 	ldexp:   x * 2^n for integral n (the full range, including subnormal results)
+	 * 	getexp:  floor(log2(x))
+	 * 	getmant: x * 2^-getexp(x), in [1, 2)
+	 *
+	 * 	These map directly onto the AVX512F instructions.
+	 */
+	static inline __m512 round(__m512 x, float, avx512_tag) {
+		return _mm512_roundscale_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	}
+	static inline __m512d round(__m512d x, double, avx512_tag) {
+		return _mm512_roundscale_pd(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	}
+	static inline __m512 ldexp(__m512 x, __m512 n, float, avx512_tag) {
+		return _mm512_scalef_ps(x, n);
+	}
+	static inline __m512d ldexp(__m512d x, __m512d n, double, avx512_tag) {
+		return _mm512_scalef_pd(x, n);
+	}
+	static inline __m512 getexp(__m512 x, float, avx512_tag) {
+		return _mm512_getexp_ps(x);
+	}
+	static inline __m512d getexp(__m512d x, double, avx512_tag) {
+		return _mm512_getexp_pd(x);
+	}
+	static inline __m512 getmant(__m512 x, float, avx512_tag) {
+		return _mm512_getmant_ps(x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_zero);
+	}
+	static inline __m512d getmant(__m512d x, double, avx512_tag) {
+		return _mm512_getmant_pd(x, _MM_MANT_NORM_1_2, _MM_MANT_SIGN_zero);
+	}
 	/*************************************************************************/
 	static inline __m512 sqrt(__m512 x, float, avx512_tag) {
 		return _mm512_sqrt_ps(x);
@@ -188,14 +408,56 @@ namespace scimd {
 	static inline __m512d sqrt(__m512d x, double, avx512_tag) {
 		return _mm512_sqrt_pd(x);
 	}
+#ifdef __AVX512ER__
+	/**
+	 * 	Knights Landing refinement
+	 *
+	 * 	AVX512ER provides a 28-bit approximation, so the float version needs
+	 * 	no refinement and the double version only needs a 2nd-order polynomial
+	 * 	(the truncation error is O(r^3) ~ 2^-84).
+	 */
+	static inline __m512 rsqrt(__m512 x, float, avx512_tag) {
+		return _mm512_rsqrt28_ps(x);
+	}
+	static inline __m512d rsqrt(__m512d a, double, avx512_tag) {
+		const __m512d one = _mm512_set1_pd(1.0), c1 = _mm512_set1_pd(1.0/2.0),
+					  c2  = _mm512_set1_pd(3.0/8.0);
+		const __m512d x = _mm512_rsqrt28_pd(a);
+		const __m512d r = fnma(_mm512_mul_pd(a, x), x, one, double{}, avx512_tag{});
+		const __m512d poly = fma(c2, r, c1, double{}, avx512_tag{});
+		return fma(_mm512_mul_pd(x, r), poly, x, double{}, avx512_tag{});
+	}
+	static inline __m512 rsqrt(__m512 x, float, avx512_tag, precision::fast) {
+		return _mm512_rsqrt28_ps(x);
+	}
+	static inline __m512d rsqrt(__m512d x, double, avx512_tag, precision::fast) {
+		return _mm512_rsqrt28_pd(x);
+	}
+	static inline __m512 rcp(__m512 x, float, avx512_tag) {
+		return _mm512_rcp28_ps(x);
+	}
+	static inline __m512d rcp(__m512d a, double, avx512_tag) {
+		// With r = 1 - a*x, 1/a = x*(1 + r + r^2 + ...) and r^3 ~ 2^-84
+		const __m512d one = _mm512_set1_pd(1.0);
+		const __m512d x = _mm512_rcp28_pd(a);
+		const __m512d r = fnma(a, x, one, double{}, avx512_tag{});
+		return fma(_mm512_mul_pd(x, r), _mm512_add_pd(one, r), x, double{}, avx512_tag{});
+	}
+	static inline __m512 rcp(__m512 x, float, avx512_tag, precision::fast) {
+		return _mm512_rcp28_ps(x);
+	}
+	static inline __m512d rcp(__m512d x, double, avx512_tag, precision::fast) {
+		return _mm512_rcp28_pd(x);
+	}
+#else
 	static inline __m512 rsqrt(__m512 x, float, avx512_tag) {
 		/**
 		 * 	Do one Newton-Raphson iteration to bring the precision to ~23 bits (~2e-7).
 		 */
 		const __m512 three = _mm512_set1_ps(3.0f), half = _mm512_set1_ps(0.5f);
 		const __m512 rsrt = _mm512_rsqrt14_ps(x);
-		const __m512 muls = _mm512_mul_ps(_mm512_mul_ps(x, rsrt), rsrt);
-		return _mm512_mul_ps(_mm512_mul_ps(half, rsrt), _mm512_sub_ps(three, muls));
+		const __m512 corr = fnma(_mm512_mul_ps(x, rsrt), rsrt, three, float{}, avx512_tag{});
+		return _mm512_mul_ps(_mm512_mul_ps(half, rsrt), corr);
 	}
 	static inline __m512d rsqrt(__m512d a, double, avx512_tag) {
 		/**
@@ -209,12 +471,40 @@ namespace scimd {
 					  c4  = _mm512_set1_pd(105.0/384.0);
 //		__m512d x = _mm512_cvtps_pd(_mm_rsqrt_ps(_mm512_cvtpd_ps(a)));
 		const __m512d x = _mm512_rsqrt14_pd(a);
-		const __m512d r = _mm512_sub_pd(one, _mm512_mul_pd(_mm512_mul_pd(a, x), x));
+		const __m512d r = fnma(_mm512_mul_pd(a, x), x, one, double{}, avx512_tag{});
 		const __m512d r2 = _mm512_mul_pd(r, r);
-		const __m512d t1 = _mm512_add_pd(_mm512_mul_pd(c2, r), c1);
-		const __m512d t3 = _mm512_add_pd(_mm512_mul_pd(c4, r), c3);
-		const __m512d poly = _mm512_add_pd(_mm512_mul_pd(r2, t3), t1);
-		return _mm512_add_pd(_mm512_mul_pd(_mm512_mul_pd(x, r), poly), x);
+		const __m512d t1 = fma(c2, r, c1, double{}, avx512_tag{});
+		const __m512d t3 = fma(c4, r, c3, double{}, avx512_tag{});
+		const __m512d poly = fma(r2, t3, t1, double{}, avx512_tag{});
+		return fma(_mm512_mul_pd(x, r), poly, x, double{}, avx512_tag{});
 	}
-
-};
+	static inline __m512 rsqrt(__m512 x, float, avx512_tag, precision::fast) {
+		return _mm512_rsqrt14_ps(x);
+	}
+	static inline __m512d rsqrt(__m512d x, double, avx512_tag, precision::fast) {
+		return _mm512_rsqrt14_pd(x);
+	}
+	static inline __m512 rcp(__m512 a, float, avx512_tag) {
+		// One Newton-Raphson iteration brings the precision to ~24 bits
+		const __m512 x = _mm512_rcp14_ps(a);
+		return fma(x, fnma(a, x, _mm512_set1_ps(1.0f), float{}, avx512_tag{}), x, float{}, avx512_tag{});
+	}
+	static inline __m512d rcp(__m512d a, double, avx512_tag) {
+		/**
+		 * 	With r = 1 - a*x, 1/a = x*(1 + r + r^2 + ...). Stopping at r^4
+		 * 	leaves an error of ~2^-70.
+		 */
+		const __m512d one = _mm512_set1_pd(1.0);
+		const __m512d x = _mm512_rcp14_pd(a);
+		const __m512d r = fnma(a, x, one, double{}, avx512_tag{});
+		const __m512d poly = _mm512_mul_pd(_mm512_add_pd(one, r), fma(r, r, one, double{}, avx512_tag{}));
+		return fma(_mm512_mul_pd(x, r), poly, x, double{}, avx512_tag{});
+	}
+	static inline __m512 rcp(__m512 x, float, avx512_tag, precision::fast) {
+		return _mm512_rcp14_ps(x);
+	}
+	static inline __m512d rcp(__m512d x, double, avx512_tag, precision::fast) {
+		return _mm512_rcp14_pd(x);
+	}
+#endif
+}}
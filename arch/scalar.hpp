@@ -5,12 +5,16 @@
 #include <algorithm>
 #include "traits.hpp"
 #include "memory.hpp"
+#include "precision.hpp"
 
-namespace scimd {
+namespace scimd { inline namespace SCIMD_ISA_NAMESPACE {
 
 	struct scalar_tag {};
 
 	template <> struct is_scalar<scalar_tag> : std::true_type{};
+#ifdef __FMA__
+	template <> struct has_fma<scalar_tag> : std::true_type{};
+#endif
 
 	struct simd_category { using type = scalar_tag; };
 
@@ -20,6 +24,10 @@ namespace scimd {
 	template <> struct bool_type<float> { using type = bool; };
 	template <> struct bool_type<double> { using type = bool; };
 
+	template <> struct index_type<float> { using type = int32_t; };
+	template <> struct index_type<double> { using type = int32_t; };
+	template <> struct index_type<double, int64_t> { using type = int64_t; };
+
 	/**
 	 * 	Tag dispatch is used here because the gcc ABI before gcc-4.9
 	 * 	does not properly mangle the SIMD types.
@@ -67,6 +75,68 @@ namespace scimd {
 	static inline double div(double x, double y, double, scalar_tag) {
 		return x / y;
 	}
+	/*************************************************************************/
+	/**
+	 * 	Fused multiply-add family
+	 *
+	 * 	fma:  x*y + z	fms:  x*y - z
+	 * 	fnma: z - x*y	fnms: -(x*y) - z
+	 *
+	 * 	When the hardware has FMA, std::fma gives the single rounding.
+	 * 	Otherwise, this is a plain multiply-add to avoid the (very slow)
+	 * 	software emulation in libm.
+	 */
+#ifdef __FMA__
+	static inline float fma(float x, float y, float z, float, scalar_tag) {
+		return std::fma(x, y, z);
+	}
+	static inline double fma(double x, double y, double z, double, scalar_tag) {
+		return std::fma(x, y, z);
+	}
+	static inline float fms(float x, float y, float z, float, scalar_tag) {
+		return std::fma(x, y, -z);
+	}
+	static inline double fms(double x, double y, double z, double, scalar_tag) {
+		return std::fma(x, y, -z);
+	}
+	static inline float fnma(float x, float y, float z, float, scalar_tag) {
+		return std::fma(-x, y, z);
+	}
+	static inline double fnma(double x, double y, double z, double, scalar_tag) {
+		return std::fma(-x, y, z);
+	}
+	static inline float fnms(float x, float y, float z, float, scalar_tag) {
+		return std::fma(-x, y, -z);
+	}
+	static inline double fnms(double x, double y, double z, double, scalar_tag) {
+		return std::fma(-x, y, -z);
+	}
+#else
+	static inline float fma(float x, float y, float z, float, scalar_tag) {
+		return x * y + z;
+	}
+	static inline double fma(double x, double y, double z, double, scalar_tag) {
+		return x * y + z;
+	}
+	static inline float fms(float x, float y, float z, float, scalar_tag) {
+		return x * y - z;
+	}
+	static inline double fms(double x, double y, double z, double, scalar_tag) {
+		return x * y - z;
+	}
+	static inline float fnma(float x, float y, float z, float, scalar_tag) {
+		return z - x * y;
+	}
+	static inline double fnma(double x, double y, double z, double, scalar_tag) {
+		return z - x * y;
+	}
+	static inline float fnms(float x, float y, float z, float, scalar_tag) {
+		return -(x * y) - z;
+	}
+	static inline double fnms(double x, double y, double z, double, scalar_tag) {
+		return -(x * y) - z;
+	}
+#endif
 	/*************************************************************************/
 	static inline float max(float x, float y, float, scalar_tag) {
 		return std::max(x,y);
@@ -106,6 +176,31 @@ namespace scimd {
 		return x >= y;
 	}
 	/*************************************************************************/
+	static inline float reduce_add(float x, float, scalar_tag) {
+		return x;
+	}
+	static inline double reduce_add(double x, double, scalar_tag) {
+		return x;
+	}
+	static inline float reduce_mul(float x, float, scalar_tag) {
+		return x;
+	}
+	static inline double reduce_mul(double x, double, scalar_tag) {
+		return x;
+	}
+	static inline float reduce_min(float x, float, scalar_tag) {
+		return x;
+	}
+	static inline double reduce_min(double x, double, scalar_tag) {
+		return x;
+	}
+	static inline float reduce_max(float x, float, scalar_tag) {
+		return x;
+	}
+	static inline double reduce_max(double x, double, scalar_tag) {
+		return x;
+	}
+	/*************************************************************************/
 	static inline bool logical_all(bool x, float, scalar_tag) {
 		return x;
 	}
@@ -118,6 +213,48 @@ namespace scimd {
 	static inline bool logical_none(bool x, double, scalar_tag) {
 		return !x;
 	}
+	static inline size_t logical_count(bool x, float, scalar_tag) {
+		return x ? 1 : 0;
+	}
+	static inline size_t logical_count(bool x, double, scalar_tag) {
+		return x ? 1 : 0;
+	}
+	static inline bool logical_and(bool x, bool y, float, scalar_tag) {
+		return x && y;
+	}
+	static inline bool logical_and(bool x, bool y, double, scalar_tag) {
+		return x && y;
+	}
+	static inline bool logical_or(bool x, bool y, float, scalar_tag) {
+		return x || y;
+	}
+	static inline bool logical_or(bool x, bool y, double, scalar_tag) {
+		return x || y;
+	}
+	static inline bool logical_xor(bool x, bool y, float, scalar_tag) {
+		return x != y;
+	}
+	static inline bool logical_xor(bool x, bool y, double, scalar_tag) {
+		return x != y;
+	}
+	static inline bool logical_not(bool x, float, scalar_tag) {
+		return !x;
+	}
+	static inline bool logical_not(bool x, double, scalar_tag) {
+		return !x;
+	}
+	static inline uint32_t to_bits(bool x, float, scalar_tag) {
+		return x ? 1 : 0;
+	}
+	static inline uint32_t to_bits(bool x, double, scalar_tag) {
+		return x ? 1 : 0;
+	}
+	static inline bool from_bits(uint32_t bits, float, scalar_tag) {
+		return (bits & 1) != 0;
+	}
+	static inline bool from_bits(uint32_t bits, double, scalar_tag) {
+		return (bits & 1) != 0;
+	}
 	/*************************************************************************/
 	static inline void store(float *p, float x, float, scalar_tag, memory::aligned) {
 		*p = x;
@@ -131,6 +268,12 @@ namespace scimd {
 	static inline void store(double *p, double x, double, scalar_tag, memory::unaligned) {
 		*p = x;
 	}
+	static inline void store(float *p, float x, float, scalar_tag, memory::streaming) {
+		*p = x;
+	}
+	static inline void store(double *p, double x, double, scalar_tag, memory::streaming) {
+		*p = x;
+	}
 	static inline float load(float const* p, float, scalar_tag, memory::unaligned) {
 		return *p;
 	}
@@ -143,12 +286,105 @@ namespace scimd {
 	static inline double load(double const* p, double, scalar_tag, memory::aligned) {
 		return *p;
 	}
+	static inline float load_n(float const* p, size_t n, float, scalar_tag) {
+		return (n > 0) ? *p : 0.0f;
+	}
+	static inline double load_n(double const* p, size_t n, double, scalar_tag) {
+		return (n > 0) ? *p : 0.0;
+	}
+	static inline void store_n(float *p, size_t n, float x, float, scalar_tag) {
+		if (n > 0) {
+			*p = x;
+		}
+	}
+	static inline void store_n(double *p, size_t n, double x, double, scalar_tag) {
+		if (n > 0) {
+			*p = x;
+		}
+	}
+	static inline int32_t load_index(int32_t const* p, float, scalar_tag) {
+		return *p;
+	}
+	static inline int32_t load_index(int32_t const* p, double, scalar_tag) {
+		return *p;
+	}
+	static inline void store_index(int32_t *p, int32_t x, float, scalar_tag) {
+		*p = x;
+	}
+	static inline void store_index(int32_t *p, int32_t x, double, scalar_tag) {
+		*p = x;
+	}
+	static inline int64_t load_index(int64_t const* p, double, scalar_tag) {
+		return *p;
+	}
+	static inline void store_index(int64_t *p, int64_t x, double, scalar_tag) {
+		*p = x;
+	}
+	static inline float gather(float const* base, int32_t idx, float, int32_t, scalar_tag) {
+		return base[idx];
+	}
+	static inline double gather(double const* base, int32_t idx, double, int32_t, scalar_tag) {
+		return base[idx];
+	}
+	static inline double gather(double const* base, int64_t idx, double, int64_t, scalar_tag) {
+		return base[idx];
+	}
+	static inline void scatter(float *base, int32_t idx, float x, float, int32_t, scalar_tag) {
+		base[idx] = x;
+	}
+	static inline void scatter(double *base, int32_t idx, double x, double, int32_t, scalar_tag) {
+		base[idx] = x;
+	}
+	static inline void scatter(double *base, int64_t idx, double x, double, int64_t, scalar_tag) {
+		base[idx] = x;
+	}
 	static inline float blend(float x, float y, bool mask, float, scalar_tag) {
 		return (mask) ? y : x;
 	}
 	static inline double blend(double x, double y, bool mask, double, scalar_tag) {
 		return (mask) ? y : x;
 	}
+	static inline float compress(float x, bool, float, scalar_tag) {
+		return x;
+	}
+	static inline double compress(double x, bool, double, scalar_tag) {
+		return x;
+	}
+	/*************************************************************************/
+	/**
+	 * 	Exponent manipulation (used by the transcendental functions)
+	 *
+	 * 	round:   round to nearest, ties to even
+	 * 	ldexp:   x * 2^n for integral n (the full range, including subnormal results)
+	 * 	getexp:  floor(log2(x))
+	 * 	getmant: x * 2^-getexp(x), in [1, 2)
+	 *
+	 * 	getexp and getmant assume x is positive and finite.
+	 */
+	static inline float round(float x, float, scalar_tag) {
+		return std::nearbyint(x);
+	}
+	static inline double round(double x, double, scalar_tag) {
+		return std::nearbyint(x);
+	}
+	static inline float ldexp(float x, float n, float, scalar_tag) {
+		return std::ldexp(x, static_cast<int>(std::min(std::max(n, -300.0f), 300.0f)));
+	}
+	static inline double ldexp(double x, double n, double, scalar_tag) {
+		return std::ldexp(x, static_cast<int>(std::min(std::max(n, -2100.0), 2100.0)));
+	}
+	static inline float getexp(float x, float, scalar_tag) {
+		return static_cast<float>(std::ilogb(x));
+	}
+	static inline double getexp(double x, double, scalar_tag) {
+		return static_cast<double>(std::ilogb(x));
+	}
+	static inline float getmant(float x, float, scalar_tag) {
+		return std::scalbn(x, -std::ilogb(x));
+	}
+	static inline double getmant(double x, double, scalar_tag) {
+		return std::scalbn(x, -std::ilogb(x));
+	}
 	/*************************************************************************/
 	static inline float sqrt(float x, float, scalar_tag) {
 		return std::sqrt(x);
@@ -162,4 +398,23 @@ namespace scimd {
 	static inline double rsqrt(double x, double, scalar_tag) {
 		return 1.0 / std::sqrt(x);
 	}
-};
+	// There are no estimates, so every precision is exact
+	static inline float rsqrt(float x, float, scalar_tag, precision::fast) {
+		return 1.0f / std::sqrt(x);
+	}
+	static inline double rsqrt(double x, double, scalar_tag, precision::fast) {
+		return 1.0 / std::sqrt(x);
+	}
+	static inline float rcp(float x, float, scalar_tag) {
+		return 1.0f / x;
+	}
+	static inline double rcp(double x, double, scalar_tag) {
+		return 1.0 / x;
+	}
+	static inline float rcp(float x, float, scalar_tag, precision::fast) {
+		return 1.0f / x;
+	}
+	static inline double rcp(double x, double, scalar_tag, precision::fast) {
+		return 1.0 / x;
+	}
+}}
@@ -2,14 +2,19 @@
 
 #include <nmmintrin.h>
 #include <cstdint>
+#include <limits>
 #include "traits.hpp"
 #include "memory.hpp"
+#include "precision.hpp"
 
-namespace scimd {
+namespace scimd { inline namespace SCIMD_ISA_NAMESPACE {
 
 	struct sse_tag {};
 
 	template<> struct is_sse<sse_tag> : std::true_type {};
+#ifdef __FMA__
+	template<> struct has_fma<sse_tag> : std::true_type {};
+#endif
 
 	struct simd_category { using type = sse_tag; };
 
@@ -19,11 +24,37 @@ namespace scimd {
 	template <> struct bool_type<float> { using type = __m128; };
 	template <> struct bool_type<double> { using type = __m128d; };
 
+	template <> struct index_type<float> { using type = __m128i; };
+	template <> struct index_type<double> { using type = __m128i; };	// low two lanes
+	template <> struct index_type<double, int64_t> { using type = __m128i; };
+
 	namespace {
 		template <typename T>
 		struct mask_t {};
 		template <> struct mask_t<float> { static const int value = 0xf; };
 		template <> struct mask_t<double> { static const int value = 0x3; };
+
+		/*
+		 * 	Byte shuffles for compress, indexed by the movemask
+		 */
+		alignas(16) const int8_t compress_lut8[16][16] = {
+			{-1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+			{0, 1, 2, 3, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+			{4, 5, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+			{0, 1, 2, 3, 4, 5, 6, 7, -1, -1, -1, -1, -1, -1, -1, -1},
+			{8, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+			{0, 1, 2, 3, 8, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1},
+			{4, 5, 6, 7, 8, 9, 10, 11, -1, -1, -1, -1, -1, -1, -1, -1},
+			{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, -1, -1, -1, -1},
+			{12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1},
+			{0, 1, 2, 3, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1},
+			{4, 5, 6, 7, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1},
+			{0, 1, 2, 3, 4, 5, 6, 7, 12, 13, 14, 15, -1, -1, -1, -1},
+			{8, 9, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1, -1, -1, -1, -1},
+			{0, 1, 2, 3, 8, 9, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1},
+			{4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, -1, -1, -1, -1},
+			{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}
+		};
 	}
 
 	/**
@@ -73,6 +104,66 @@ namespace scimd {
 	static inline __m128d div(__m128d x, __m128d y, double, sse_tag) {
 		return _mm_div_pd(x, y);
 	}
+	/*************************************************************************/
+	/**
+	 * 	Fused multiply-add family
+	 *
+	 * 	fma:  x*y + z	fms:  x*y - z
+	 * 	fnma: z - x*y	fnms: -(x*y) - z
+	 *
+	 * 	Without FMA hardware, these fall back to a separate multiply and add.
+	 */
+#ifdef __FMA__
+	static inline __m128 fma(__m128 x, __m128 y, __m128 z, float, sse_tag) {
+		return _mm_fmadd_ps(x, y, z);
+	}
+	static inline __m128d fma(__m128d x, __m128d y, __m128d z, double, sse_tag) {
+		return _mm_fmadd_pd(x, y, z);
+	}
+	static inline __m128 fms(__m128 x, __m128 y, __m128 z, float, sse_tag) {
+		return _mm_fmsub_ps(x, y, z);
+	}
+	static inline __m128d fms(__m128d x, __m128d y, __m128d z, double, sse_tag) {
+		return _mm_fmsub_pd(x, y, z);
+	}
+	static inline __m128 fnma(__m128 x, __m128 y, __m128 z, float, sse_tag) {
+		return _mm_fnmadd_ps(x, y, z);
+	}
+	static inline __m128d fnma(__m128d x, __m128d y, __m128d z, double, sse_tag) {
+		return _mm_fnmadd_pd(x, y, z);
+	}
+	static inline __m128 fnms(__m128 x, __m128 y, __m128 z, float, sse_tag) {
+		return _mm_fnmsub_ps(x, y, z);
+	}
+	static inline __m128d fnms(__m128d x, __m128d y, __m128d z, double, sse_tag) {
+		return _mm_fnmsub_pd(x, y, z);
+	}
+#else
+	static inline __m128 fma(__m128 x, __m128 y, __m128 z, float, sse_tag) {
+		return _mm_add_ps(_mm_mul_ps(x, y), z);
+	}
+	static inline __m128d fma(__m128d x, __m128d y, __m128d z, double, sse_tag) {
+		return _mm_add_pd(_mm_mul_pd(x, y), z);
+	}
+	static inline __m128 fms(__m128 x, __m128 y, __m128 z, float, sse_tag) {
+		return _mm_sub_ps(_mm_mul_ps(x, y), z);
+	}
+	static inline __m128d fms(__m128d x, __m128d y, __m128d z, double, sse_tag) {
+		return _mm_sub_pd(_mm_mul_pd(x, y), z);
+	}
+	static inline __m128 fnma(__m128 x, __m128 y, __m128 z, float, sse_tag) {
+		return _mm_sub_ps(z, _mm_mul_ps(x, y));
+	}
+	static inline __m128d fnma(__m128d x, __m128d y, __m128d z, double, sse_tag) {
+		return _mm_sub_pd(z, _mm_mul_pd(x, y));
+	}
+	static inline __m128 fnms(__m128 x, __m128 y, __m128 z, float, sse_tag) {
+		return _mm_sub_ps(_mm_sub_ps(_mm_setzero_ps(), _mm_mul_ps(x, y)), z);
+	}
+	static inline __m128d fnms(__m128d x, __m128d y, __m128d z, double, sse_tag) {
+		return _mm_sub_pd(_mm_sub_pd(_mm_setzero_pd(), _mm_mul_pd(x, y)), z);
+	}
+#endif
 	/*************************************************************************/
 	static inline __m128 max(__m128 x, __m128 y, float, sse_tag) {
 		return _mm_max_ps(x, y);
@@ -112,6 +203,41 @@ namespace scimd {
 		return _mm_cmpge_pd(x, y);
 	}
 	/*************************************************************************/
+	/**
+	 * 	Horizontal reductions
+	 *
+	 * 	These use a shuffle tree: fold the high half onto the low half
+	 * 	until a single lane remains.
+	 */
+	static inline float reduce_add(__m128 x, float, sse_tag) {
+		const __m128 t = _mm_add_ps(x, _mm_movehl_ps(x, x));
+		return _mm_cvtss_f32(_mm_add_ss(t, _mm_shuffle_ps(t, t, 0x55)));
+	}
+	static inline double reduce_add(__m128d x, double, sse_tag) {
+		return _mm_cvtsd_f64(_mm_add_sd(x, _mm_unpackhi_pd(x, x)));
+	}
+	static inline float reduce_mul(__m128 x, float, sse_tag) {
+		const __m128 t = _mm_mul_ps(x, _mm_movehl_ps(x, x));
+		return _mm_cvtss_f32(_mm_mul_ss(t, _mm_shuffle_ps(t, t, 0x55)));
+	}
+	static inline double reduce_mul(__m128d x, double, sse_tag) {
+		return _mm_cvtsd_f64(_mm_mul_sd(x, _mm_unpackhi_pd(x, x)));
+	}
+	static inline float reduce_min(__m128 x, float, sse_tag) {
+		const __m128 t = _mm_min_ps(x, _mm_movehl_ps(x, x));
+		return _mm_cvtss_f32(_mm_min_ss(t, _mm_shuffle_ps(t, t, 0x55)));
+	}
+	static inline double reduce_min(__m128d x, double, sse_tag) {
+		return _mm_cvtsd_f64(_mm_min_sd(x, _mm_unpackhi_pd(x, x)));
+	}
+	static inline float reduce_max(__m128 x, float, sse_tag) {
+		const __m128 t = _mm_max_ps(x, _mm_movehl_ps(x, x));
+		return _mm_cvtss_f32(_mm_max_ss(t, _mm_shuffle_ps(t, t, 0x55)));
+	}
+	static inline double reduce_max(__m128d x, double, sse_tag) {
+		return _mm_cvtsd_f64(_mm_max_sd(x, _mm_unpackhi_pd(x, x)));
+	}
+	/*************************************************************************/
 	static inline bool logical_all(__m128 x, float, sse_tag) {
 		return _mm_movemask_ps(x) == mask_t<float>::value;
 	}
@@ -124,6 +250,55 @@ namespace scimd {
 	static inline bool logical_none(__m128d x, double, sse_tag) {
 		return _mm_movemask_pd(x) == 0;
 	}
+	static inline size_t logical_count(__m128 x, float, sse_tag) {
+		return static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(_mm_movemask_ps(x))));
+	}
+	static inline size_t logical_count(__m128d x, double, sse_tag) {
+		return static_cast<size_t>(__builtin_popcount(static_cast<unsigned>(_mm_movemask_pd(x))));
+	}
+	static inline __m128 logical_and(__m128 x, __m128 y, float, sse_tag) {
+		return _mm_and_ps(x, y);
+	}
+	static inline __m128d logical_and(__m128d x, __m128d y, double, sse_tag) {
+		return _mm_and_pd(x, y);
+	}
+	static inline __m128 logical_or(__m128 x, __m128 y, float, sse_tag) {
+		return _mm_or_ps(x, y);
+	}
+	static inline __m128d logical_or(__m128d x, __m128d y, double, sse_tag) {
+		return _mm_or_pd(x, y);
+	}
+	static inline __m128 logical_xor(__m128 x, __m128 y, float, sse_tag) {
+		return _mm_xor_ps(x, y);
+	}
+	static inline __m128d logical_xor(__m128d x, __m128d y, double, sse_tag) {
+		return _mm_xor_pd(x, y);
+	}
+	static inline __m128 logical_not(__m128 x, float, sse_tag) {
+		return _mm_xor_ps(x, _mm_castsi128_ps(_mm_set1_epi32(-1)));
+	}
+	static inline __m128d logical_not(__m128d x, double, sse_tag) {
+		return _mm_xor_pd(x, _mm_castsi128_pd(_mm_set1_epi32(-1)));
+	}
+	/**
+	 * 	Bit i of to_bits is lane i of the mask.
+	 */
+	static inline uint32_t to_bits(__m128 x, float, sse_tag) {
+		return static_cast<uint32_t>(_mm_movemask_ps(x));
+	}
+	static inline uint32_t to_bits(__m128d x, double, sse_tag) {
+		return static_cast<uint32_t>(_mm_movemask_pd(x));
+	}
+	static inline __m128 from_bits(uint32_t bits, float, sse_tag) {
+		const __m128i lanes = _mm_setr_epi32(1, 2, 4, 8);
+		const __m128i x = _mm_and_si128(_mm_set1_epi32(static_cast<int>(bits)), lanes);
+		return _mm_castsi128_ps(_mm_cmpeq_epi32(x, lanes));
+	}
+	static inline __m128d from_bits(uint32_t bits, double, sse_tag) {
+		const __m128i lanes = _mm_set_epi64x(2, 1);
+		const __m128i x = _mm_and_si128(_mm_set1_epi64x(bits), lanes);
+		return _mm_castsi128_pd(_mm_cmpeq_epi64(x, lanes));
+	}
 	/*************************************************************************/
 	static inline void store(float *p, __m128 x, float, sse_tag, memory::unaligned) {
 		_mm_storeu_ps(p, x);
@@ -137,6 +312,12 @@ namespace scimd {
 	static inline void store(double *p, __m128d x, double, sse_tag, memory::aligned) {
 		_mm_store_pd(p, x);
 	}
+	static inline void store(float *p, __m128 x, float, sse_tag, memory::streaming) {
+		_mm_stream_ps(p, x);
+	}
+	static inline void store(double *p, __m128d x, double, sse_tag, memory::streaming) {
+		_mm_stream_pd(p, x);
+	}
 	static inline __m128 load(float const* p, float, sse_tag, memory::unaligned) {
 		return _mm_loadu_ps(p);
 	}
@@ -149,12 +330,161 @@ namespace scimd {
 	static inline __m128d load(double const* p, double, sse_tag, memory::aligned) {
 		return _mm_load_pd(p);
 	}
+	/**
+	 * 	SSE has no masked moves (maskmovdqu is a non-temporal byte store), so
+	 * 	partial loads and stores go through a copy loop. At most 3 elements
+	 * 	are copied.
+	 */
+	static inline __m128 load_n(float const* p, size_t n, float, sse_tag) {
+		alignas(16) float tmp[4] = {};
+		for (size_t i = 0; i < n; i++) {
+			tmp[i] = p[i];
+		}
+		return _mm_load_ps(tmp);
+	}
+	static inline __m128d load_n(double const* p, size_t n, double, sse_tag) {
+		return (n > 1) ? _mm_loadu_pd(p) : (n > 0) ? _mm_load_sd(p) : _mm_setzero_pd();
+	}
+	static inline void store_n(float *p, size_t n, __m128 x, float, sse_tag) {
+		alignas(16) float tmp[4];
+		_mm_store_ps(tmp, x);
+		for (size_t i = 0; i < n; i++) {
+			p[i] = tmp[i];
+		}
+	}
+	static inline void store_n(double *p, size_t n, __m128d x, double, sse_tag) {
+		if (n > 1) {
+			_mm_storeu_pd(p, x);
+		} else if (n > 0) {
+			_mm_store_sd(p, x);
+		}
+	}
+	/**
+	 * 	SSE has no gather or scatter, so these are emulated one lane at a time.
+	 */
+	static inline __m128i load_index(int32_t const* p, float, sse_tag) {
+		return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+	}
+	static inline __m128i load_index(int32_t const* p, double, sse_tag) {
+		return _mm_loadl_epi64(reinterpret_cast<__m128i const*>(p));
+	}
+	static inline void store_index(int32_t *p, __m128i x, float, sse_tag) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(p), x);
+	}
+	static inline void store_index(int32_t *p, __m128i x, double, sse_tag) {
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(p), x);
+	}
+	static inline __m128i load_index(int64_t const* p, double, sse_tag) {
+		return _mm_loadu_si128(reinterpret_cast<__m128i const*>(p));
+	}
+	static inline void store_index(int64_t *p, __m128i x, double, sse_tag) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(p), x);
+	}
+	static inline __m128 gather(float const* base, __m128i idx, float, int32_t, sse_tag) {
+		return _mm_setr_ps(base[_mm_cvtsi128_si32(idx)],    base[_mm_extract_epi32(idx, 1)],
+						   base[_mm_extract_epi32(idx, 2)], base[_mm_extract_epi32(idx, 3)]);
+	}
+	static inline __m128d gather(double const* base, __m128i idx, double, int32_t, sse_tag) {
+		return _mm_setr_pd(base[_mm_cvtsi128_si32(idx)], base[_mm_extract_epi32(idx, 1)]);
+	}
+	static inline __m128d gather(double const* base, __m128i idx, double, int64_t, sse_tag) {
+		alignas(16) int64_t i[2];
+		_mm_store_si128(reinterpret_cast<__m128i*>(i), idx);
+		return _mm_setr_pd(base[i[0]], base[i[1]]);
+	}
+	static inline void scatter(float *base, __m128i idx, __m128 x, float, int32_t, sse_tag) {
+		alignas(16) float tmp[4];
+		alignas(16) int32_t i[4];
+		_mm_store_ps(tmp, x);
+		_mm_store_si128(reinterpret_cast<__m128i*>(i), idx);
+		for (int k = 0; k < 4; k++) {
+			base[i[k]] = tmp[k];
+		}
+	}
+	static inline void scatter(double *base, __m128i idx, __m128d x, double, int32_t, sse_tag) {
+		_mm_storel_pd(base + _mm_cvtsi128_si32(idx), x);
+		_mm_storeh_pd(base + _mm_extract_epi32(idx, 1), x);
+	}
+	static inline void scatter(double *base, __m128i idx, __m128d x, double, int64_t, sse_tag) {
+		alignas(16) int64_t i[2];
+		_mm_store_si128(reinterpret_cast<__m128i*>(i), idx);
+		_mm_storel_pd(base + i[0], x);
+		_mm_storeh_pd(base + i[1], x);
+	}
 	static inline __m128 blend(__m128 x, __m128 y, __m128 mask, float, sse_tag) {
 		return _mm_blendv_ps(x, y, mask);
 	}
 	static inline __m128d blend(__m128d x, __m128d y, __m128d mask, double, sse_tag) {
 		return _mm_blendv_pd(x, y, mask);
 	}
+	/**
+	 * 	Compress moves the lanes selected by the mask to the front, in order.
+	 * 	The remaining lanes are unspecified.
+	 */
+	static inline __m128 compress(__m128 x, __m128 mask, float, sse_tag) {
+		const __m128i shuffle = _mm_load_si128(reinterpret_cast<__m128i const*>(compress_lut8[_mm_movemask_ps(mask)]));
+		return _mm_castsi128_ps(_mm_shuffle_epi8(_mm_castps_si128(x), shuffle));
+	}
+	static inline __m128d compress(__m128d x, __m128d mask, double, sse_tag) {
+		// The upper lane moves down unless the lower one is selected
+		return _mm_blendv_pd(_mm_unpackhi_pd(x, x), x, mask);
+	}
+	/*************************************************************************/
+	/**
+	 * 	Exponent manipulation (used by the transcendental functions)
+	 *
+	 * 	round:   round to nearest, ties to even
+	 * 	ldexp:   x * 2^n for integral n (the full range, including subnormal results)
+	 * 	getexp:  floor(log2(x))
+	 * 	getmant: x * 2^-getexp(x), in [1, 2)
+	 *
+	 * 	getexp and getmant assume x is positive and normal.
+	 *
+	 * 	ldexp builds 2^n in two halves so that each is a normal number.
+	 */
+	static inline __m128 round(__m128 x, float, sse_tag) {
+		return _mm_round_ps(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	}
+	static inline __m128d round(__m128d x, double, sse_tag) {
+		return _mm_round_pd(x, _MM_FROUND_TO_NEAREST_INT | _MM_FROUND_NO_EXC);
+	}
+	static inline __m128 ldexp(__m128 x, __m128 n, float, sse_tag) {
+		n = _mm_min_ps(_mm_max_ps(n, _mm_set1_ps(-252.0f)), _mm_set1_ps(254.0f));
+		const __m128 n1 = _mm_floor_ps(_mm_mul_ps(n, _mm_set1_ps(0.5f)));
+		const __m128 n2 = _mm_sub_ps(n, n1);
+		const __m128i bias = _mm_set1_epi32(127);
+		const __m128i e1 = _mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n1), bias), 23);
+		const __m128i e2 = _mm_slli_epi32(_mm_add_epi32(_mm_cvtps_epi32(n2), bias), 23);
+		return _mm_mul_ps(_mm_mul_ps(x, _mm_castsi128_ps(e1)), _mm_castsi128_ps(e2));
+	}
+	static inline __m128d ldexp(__m128d x, __m128d n, double, sse_tag) {
+		n = _mm_min_pd(_mm_max_pd(n, _mm_set1_pd(-2044.0)), _mm_set1_pd(2046.0));
+		const __m128d n1 = _mm_floor_pd(_mm_mul_pd(n, _mm_set1_pd(0.5)));
+		const __m128d n2 = _mm_sub_pd(n, n1);
+		const __m128i bias = _mm_set1_epi32(1023), zero = _mm_setzero_si128();
+		// Place the biased exponent in the high dword of each 64-bit lane
+		const __m128i e1 = _mm_slli_epi32(_mm_add_epi32(_mm_cvtpd_epi32(n1), bias), 20);
+		const __m128i e2 = _mm_slli_epi32(_mm_add_epi32(_mm_cvtpd_epi32(n2), bias), 20);
+		return _mm_mul_pd(_mm_mul_pd(x, _mm_castsi128_pd(_mm_unpacklo_epi32(zero, e1))),
+						  _mm_castsi128_pd(_mm_unpacklo_epi32(zero, e2)));
+	}
+	static inline __m128 getexp(__m128 x, float, sse_tag) {
+		const __m128i e = _mm_srli_epi32(_mm_castps_si128(x), 23);
+		return _mm_cvtepi32_ps(_mm_sub_epi32(e, _mm_set1_epi32(127)));
+	}
+	static inline __m128d getexp(__m128d x, double, sse_tag) {
+		const __m128i e = _mm_srli_epi64(_mm_castpd_si128(x), 52);
+		const __m128i lo = _mm_shuffle_epi32(e, _MM_SHUFFLE(3, 1, 2, 0));
+		return _mm_cvtepi32_pd(_mm_sub_epi32(lo, _mm_set1_epi32(1023)));
+	}
+	static inline __m128 getmant(__m128 x, float, sse_tag) {
+		const __m128 mask = _mm_castsi128_ps(_mm_set1_epi32(0x007fffff));
+		return _mm_or_ps(_mm_and_ps(x, mask), _mm_set1_ps(1.0f));
+	}
+	static inline __m128d getmant(__m128d x, double, sse_tag) {
+		const __m128d mask = _mm_castsi128_pd(_mm_set1_epi64x(0x000fffffffffffffLL));
+		return _mm_or_pd(_mm_and_pd(x, mask), _mm_set1_pd(1.0));
+	}
 	/*************************************************************************/
 	static inline __m128 sqrt(__m128 x, float, sse_tag) {
 		return _mm_sqrt_ps(x);
@@ -170,8 +500,19 @@ namespace scimd {
 		 */
 		const __m128 three = _mm_set1_ps(3.0f), half = _mm_set1_ps(0.5f);
 		const __m128 rsrt = _mm_rsqrt_ps(x);
-		const __m128 muls = _mm_mul_ps(_mm_mul_ps(x, rsrt), rsrt);
-		return _mm_mul_ps(_mm_mul_ps(half, rsrt), _mm_sub_ps(three, muls));
+		const __m128 corr = fnma(_mm_mul_ps(x, rsrt), rsrt, three, float{}, sse_tag{});
+		return _mm_mul_ps(_mm_mul_ps(half, rsrt), corr);
+	}
+	/**
+	 * 	The double-precision rsqrt and rcp refine a single-precision estimate,
+	 * 	which is only valid where the argument and its result are normal
+	 * 	floats. Check that every lane of `x` is in [2^-126, 2^126]; this is
+	 * 	false for 0, inf, and NaN.
+	 */
+	static inline bool in_float_range(__m128d x) {
+		const __m128d lo = _mm_set1_pd(static_cast<double>(std::numeric_limits<float>::min()));
+		const __m128d hi = _mm_set1_pd(1.0 / static_cast<double>(std::numeric_limits<float>::min()));
+		return _mm_movemask_pd(_mm_and_pd(_mm_cmpge_pd(x, lo), _mm_cmple_pd(x, hi))) == 0x3;
 	}
 	static inline __m128d rsqrt(__m128d a, double, sse_tag) {
 		/**
@@ -183,15 +524,49 @@ namespace scimd {
 		* 	The speedup compared to using sqrt+div varies by CPU architecture, but
 		* 	is between 10% (Skylake) and 3x (Sandybridge) faster.
 		*/
+		if (!in_float_range(a)) {
+			return _mm_div_pd(_mm_set1_pd(1.0), _mm_sqrt_pd(a));
+		}
 		__m128d one = _mm_set1_pd(1.0), 	c1 = _mm_set1_pd(1.0/2.0),
 				c2 = _mm_set1_pd(3.0/8.0), 	c3 = _mm_set1_pd(15.0/48.0),
 				c4 = _mm_set1_pd(105.0/384.0);
 		__m128d x = _mm_cvtps_pd(_mm_rsqrt_ps(_mm_cvtpd_ps(a)));
-		__m128d r = _mm_sub_pd(one, _mm_mul_pd(_mm_mul_pd(a, x), x));
+		__m128d r = fnma(_mm_mul_pd(a, x), x, one, double{}, sse_tag{});
 		__m128d r2 = _mm_mul_pd(r, r);
-		__m128d t1 = _mm_add_pd(_mm_mul_pd(c2, r), c1);
-		__m128d t3 = _mm_add_pd(_mm_mul_pd(c4, r), c3);
-		__m128d poly = _mm_add_pd(_mm_mul_pd(r2, t3), t1);
-		return _mm_add_pd(_mm_mul_pd(_mm_mul_pd(x, r), poly), x);
+		__m128d t1 = fma(c2, r, c1, double{}, sse_tag{});
+		__m128d t3 = fma(c4, r, c3, double{}, sse_tag{});
+		__m128d poly = fma(r2, t3, t1, double{}, sse_tag{});
+		return fma(_mm_mul_pd(x, r), poly, x, double{}, sse_tag{});
 	}
-};
+	static inline __m128 rsqrt(__m128 x, float, sse_tag, precision::fast) {
+		return _mm_rsqrt_ps(x);
+	}
+	static inline __m128d rsqrt(__m128d x, double, sse_tag, precision::fast) {
+		return _mm_cvtps_pd(_mm_rsqrt_ps(_mm_cvtpd_ps(x)));
+	}
+	static inline __m128 rcp(__m128 a, float, sse_tag) {
+		// One Newton-Raphson iteration brings the precision to ~23 bits
+		const __m128 x = _mm_rcp_ps(a);
+		return fma(x, fnma(a, x, _mm_set1_ps(1.0f), float{}, sse_tag{}), x, float{}, sse_tag{});
+	}
+	static inline __m128d rcp(__m128d a, double, sse_tag) {
+		/**
+		 * 	With r = 1 - a*x, 1/a = x*(1 + r + r^2 + ...). Stopping at r^4
+		 * 	leaves an error of ~2^-58.
+		 */
+		const __m128d one = _mm_set1_pd(1.0);
+		if (!in_float_range(_mm_andnot_pd(_mm_set1_pd(-0.0), a))) {
+			return _mm_div_pd(one, a);
+		}
+		const __m128d x = _mm_cvtps_pd(_mm_rcp_ps(_mm_cvtpd_ps(a)));
+		const __m128d r = fnma(a, x, one, double{}, sse_tag{});
+		const __m128d poly = _mm_mul_pd(_mm_add_pd(one, r), fma(r, r, one, double{}, sse_tag{}));
+		return fma(_mm_mul_pd(x, r), poly, x, double{}, sse_tag{});
+	}
+	static inline __m128 rcp(__m128 x, float, sse_tag, precision::fast) {
+		return _mm_rcp_ps(x);
+	}
+	static inline __m128d rcp(__m128d x, double, sse_tag, precision::fast) {
+		return _mm_cvtps_pd(_mm_rcp_ps(_mm_cvtpd_ps(x)));
+	}
+}}
@@ -1,8 +1,9 @@
 #pragma once
 
+#include <cstdint>
 #include <type_traits>
 
-namespace scimd {
+namespace scimd { inline namespace SCIMD_ISA_NAMESPACE {
 
 	template <typename T>
 	struct simd_type {};
@@ -10,6 +11,15 @@ namespace scimd {
 	template <typename T>
 	struct bool_type {};
 
+	/**
+	 * \brief SIMD type holding one index of type I per lane of simd_type<T>
+	 *
+	 * int32_t indices are available for float and double, int64_t only
+	 * for double.
+	 */
+	template <typename T, typename I = int32_t>
+	struct index_type {};
+
 	template <typename T>
 	struct is_scalar : std::false_type {};
 
@@ -21,4 +31,10 @@ namespace scimd {
 
 	template <typename T>
 	struct is_avx512 : std::false_type {};
-}
+
+	/**
+	 * \brief Whether the backend's fma rounds once (i.e., is a true fused multiply-add)
+	 */
+	template <typename T>
+	struct has_fma : std::false_type {};
+}}
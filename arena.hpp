@@ -0,0 +1,209 @@
+#pragma once
+
+#include "scimd.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <vector>
+
+/**
+ * 	Arena (bump) allocation for scratch buffers
+ *
+ * 	An arena hands out blocks by advancing an offset into large chunks that
+ * 	it keeps for its whole life. Allocating is a few instructions, freeing
+ * 	an individual block does nothing, and reset() makes all of the memory
+ * 	available again in O(1). Once the chunks are large enough for a kernel's
+ * 	scratch buffers, the kernel never calls malloc or free again.
+ *
+ * 	Scoped use, e.g., for the staging buffers of one timestep:
+ *
+ * 		auto& a = scimd::thread_arena();
+ * 		{
+ * 			scimd::arena::scope s{a};
+ * 			float* x = a.allocate<float>(n);
+ * 			std::vector<float, scimd::arena_allocator<float>> y(n);
+ * 			...
+ * 		}	// everything allocated in the scope is released here
+ *
+ * 	An arena is not thread-safe; thread_arena() gives each thread its own.
+ */
+namespace scimd { inline namespace SCIMD_ISA_NAMESPACE {
+
+	class arena {
+	public:
+		/**
+		 * \brief A position in the arena to roll back to
+		 */
+		struct checkpoint_t {
+			size_t chunk, offset;
+		};
+
+		/**
+		 * \brief Roll back to the position at construction when destroyed
+		 */
+		class scope {
+		public:
+			explicit scope(arena& a) noexcept : arena_(a), mark_{a.checkpoint()} {}
+			~scope() { arena_.rollback(mark_); }
+			scope(scope const&) = delete;
+			scope& operator=(scope const&) = delete;
+
+		private:
+			arena& arena_;
+			checkpoint_t mark_;
+		};
+
+		/**
+		 * \param chunk_size The size in bytes of the first chunk. Each further
+		 * 					 chunk is at least twice the size of the one before.
+		 */
+		explicit arena(size_t chunk_size = size_t{1} << 20) noexcept : next_size_{chunk_size} {}
+		~arena() { release(); }
+		arena(arena const&) = delete;
+		arena& operator=(arena const&) = delete;
+
+		/**
+		 * \brief Get `bytes` bytes aligned to `align` (a power of two)
+		 */
+		void* allocate(size_t bytes, size_t align) {
+			for (;;) {
+				if (current_ < chunks_.size()) {
+					chunk const& c = chunks_[current_];
+					uintptr_t const base = reinterpret_cast<uintptr_t>(c.data);
+					size_t const start = static_cast<size_t>(((base + offset_ + align - 1) & ~(uintptr_t{align} - 1)) - base);
+					if (start + bytes <= c.size) {
+						offset_ = start + bytes;
+						return c.data + start;
+					}
+					// Move on to the next chunk (which may have been kept from before a rollback)
+					current_++;
+					offset_ = 0;
+					continue;
+				}
+				add_chunk(bytes + align);
+			}
+		}
+
+		/**
+		 * \brief Get room for `n` T's aligned for pack<T> (and padded to a whole pack)
+		 */
+		template <typename T>
+		T* allocate(size_t n) {
+			constexpr size_t align = pack_alignment<T>::value;
+			size_t const bytes = (n * sizeof(T) + align - 1) / align * align;
+			return static_cast<T*>(allocate(bytes, align));
+		}
+
+		checkpoint_t checkpoint() const noexcept { return {current_, offset_}; }
+
+		/**
+		 * \brief Release everything allocated since `mark`
+		 */
+		void rollback(checkpoint_t mark) noexcept {
+			current_ = mark.chunk;
+			offset_ = mark.offset;
+		}
+
+		/**
+		 * \brief Release every allocation, keeping the memory for reuse
+		 */
+		void reset() noexcept { rollback({0, 0}); }
+
+		/**
+		 * \brief Return all of the memory to the system
+		 */
+		void release() noexcept {
+			for (auto& c : chunks_) {
+				heap_.deallocate(c.data, c.size);
+			}
+			chunks_.clear();
+			reset();
+		}
+
+		/**
+		 * \brief The total size of the chunks, in bytes
+		 */
+		size_t capacity() const noexcept {
+			size_t total = 0;
+			for (auto const& c : chunks_) {
+				total += c.size;
+			}
+			return total;
+		}
+
+	private:
+		struct chunk {
+			char* data;
+			size_t size;
+		};
+
+		// Cache-line aligned, which covers every pack
+		allocator<char, 64> heap_;
+		std::vector<chunk> chunks_;
+		size_t current_{0};
+		size_t offset_{0};
+		size_t next_size_;
+
+		void add_chunk(size_t min_bytes) {
+			size_t const size = std::max(next_size_, min_bytes);
+			chunks_.push_back({nullptr, size});
+			chunks_.back().data = heap_.allocate(size);
+			next_size_ = 2 * size;
+		}
+	};
+
+	/**
+	 * \brief The calling thread's arena
+	 */
+	inline arena& thread_arena() {
+		static thread_local arena a;
+		return a;
+	}
+
+	/**
+	 * \brief A standard allocator that takes its memory from an arena
+	 *
+	 * Deallocation does nothing; the memory comes back when the arena is
+	 * reset or rolled back. A growing container therefore leaves its old
+	 * buffers behind, so reserve() the final size first. By default, the
+	 * allocator uses the constructing thread's arena. Allocators compare
+	 * equal when they share an arena.
+	 */
+	template <typename T>
+	class arena_allocator {
+	public:
+		using value_type = T;
+		using propagate_on_container_copy_assignment = std::true_type;
+		using propagate_on_container_move_assignment = std::true_type;
+		using propagate_on_container_swap = std::true_type;
+		using is_always_equal = std::false_type;
+
+		template <typename U>
+		struct rebind {
+			using other = arena_allocator<U>;
+		};
+
+		arena_allocator() noexcept : arena_{&thread_arena()} {}
+		explicit arena_allocator(arena& a) noexcept : arena_{&a} {}
+		template <typename U>
+		arena_allocator(arena_allocator<U> const& other) noexcept : arena_{other.get_arena()} {}
+
+		T* allocate(size_t n) { return arena_->allocate<T>(n); }
+		void deallocate(T*, size_t) noexcept {}
+
+		arena* get_arena() const noexcept { return arena_; }
+
+	private:
+		arena* arena_;
+	};
+
+	template <typename T, typename U>
+	bool operator==(arena_allocator<T> const& a, arena_allocator<U> const& b) noexcept {
+		return a.get_arena() == b.get_arena();
+	}
+	template <typename T, typename U>
+	bool operator!=(arena_allocator<T> const& a, arena_allocator<U> const& b) noexcept {
+		return !(a == b);
+	}
+}}
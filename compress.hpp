@@ -0,0 +1,107 @@
+#pragma once
+
+#include "scimd.hpp"
+#include "arena.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+/**
+ * 	Stream compaction
+ *
+ * 	copy_if, partition_copy, and partition select the elements of an array
+ * 	with a predicate over packs, pred(pack<T>) -> conditional_t<pack<T>>:
+ *
+ * 		auto end = scimd::copy_if(r, r + n, out, [rcut](pack<float> x) { return x < rcut; });
+ *
+ * 	Each pack is compressed in a register (see compress()) and stored whole,
+ * 	so the output advances by the number of selected lanes without a branch.
+ * 	Because whole packs are stored, an output must have room for the entire
+ * 	input, and its contents past the returned end are unspecified. The
+ * 	output may be the input itself, but must not otherwise overlap it.
+ *
+ * 	In the last, partial pack, the predicate sees zeros past the end of the
+ * 	input; those lanes are never selected.
+ */
+namespace scimd { inline namespace SCIMD_ISA_NAMESPACE {
+
+	namespace detail {
+		// Store the selected lanes of `x` at `out` using a whole-pack store
+		template <typename T>
+		T* compress_pack(T* out, pack<T> x, conditional_t<pack<T>> mask) {
+			::compress(x, mask).store(out);
+			return out + ::count(mask);
+		}
+	}
+
+	/**
+	 * \brief Copy the elements of [first, last) selected by `pred` to `out`, in order
+	 *
+	 * \returns The end of the copied elements
+	 */
+	template <typename T, typename Pred>
+	T* copy_if(T const* first, T const* last, T* out, Pred pred) {
+		constexpr size_t N = pack<T>::size;
+		size_t const n = static_cast<size_t>(last - first);
+		size_t i = 0;
+		for (; i + N <= n; i += N) {
+			pack<T> x;
+			x.load(first + i);
+			out = detail::compress_pack(out, x, pred(x));
+		}
+		if (i < n) {
+			pack<T> x;
+			x.load_n(first + i, n - i);
+			out += ::compress_store(out, x, pred(x) && detail::first_lanes<T>(n - i));
+		}
+		return out;
+	}
+
+	/**
+	 * \brief Copy the elements of [first, last) selected by `pred` to `out_true`
+	 * 		  and the others to `out_false`, each in order
+	 *
+	 * \returns The ends of the two outputs
+	 */
+	template <typename T, typename Pred>
+	std::pair<T*, T*> partition_copy(T const* first, T const* last, T* out_true, T* out_false, Pred pred) {
+		constexpr size_t N = pack<T>::size;
+		size_t const n = static_cast<size_t>(last - first);
+		size_t i = 0;
+		for (; i + N <= n; i += N) {
+			pack<T> x;
+			x.load(first + i);
+			auto const mask = pred(x);
+			out_true = detail::compress_pack(out_true, x, mask);
+			out_false = detail::compress_pack(out_false, x, !mask);
+		}
+		if (i < n) {
+			pack<T> x;
+			x.load_n(first + i, n - i);
+			auto const mask = pred(x);
+			out_true += ::compress_store(out_true, x, mask && detail::first_lanes<T>(n - i));
+			out_false += ::compress_store(out_false, x, !mask && detail::first_lanes<T>(n - i));
+		}
+		return {out_true, out_false};
+	}
+
+	/**
+	 * \brief Reorder [first, last) so that the elements selected by `pred` come first
+	 *
+	 * The partition is stable. The unselected elements are staged in the
+	 * calling thread's arena (see arena.hpp), so repeated calls do not
+	 * allocate once it has grown to the size of the input.
+	 *
+	 * \returns The first unselected element
+	 */
+	template <typename T, typename Pred>
+	T* partition(T* first, T* last, Pred pred) {
+		auto& scratch = thread_arena();
+		arena::scope s{scratch};
+		T* const rest = scratch.allocate<T>(static_cast<size_t>(last - first));
+		auto const ends = partition_copy(static_cast<T const*>(first), static_cast<T const*>(last), first, rest, pred);
+		std::copy(rest, ends.second, ends.first);
+		return ends.first;
+	}
+}}
@@ -0,0 +1,187 @@
+#pragma once
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+#include <cstdint>
+#include <stdexcept>
+
+namespace scimd {
+	namespace dispatch {
+		/**
+		 * \brief Instruction sets a kernel can be compiled for
+		 *
+		 * These are ordered so that a CPU supporting one level supports
+		 * every level below it.
+		 *
+		 * 	avx2 is the AVX backend compiled with AVX2+FMA (i.e., -mavx2 -mfma)
+		 * 	avx512 is the AVX-512 backend using only AVX512F (Skylake-X and later)
+		 * 	knl is the AVX-512 backend with the AVX512ER/PF refinements
+		 */
+		enum class isa : int { scalar = 0, sse, avx, avx2, avx512, knl };
+
+		struct cpu_features {
+			bool sse42{false};
+			bool avx{false};
+			bool avx2{false};
+			bool fma{false};
+			bool avx512f{false};
+			bool avx512cd{false};
+			bool avx512er{false};
+			bool avx512pf{false};
+		};
+
+#if defined(__x86_64__) || defined(__i386__)
+		namespace detail {
+			/*
+			 * 	xgetbv is issued directly so that this header does not need
+			 * 	to be compiled with -mxsave.
+			 */
+			inline uint64_t xgetbv(uint32_t idx) {
+				uint32_t eax, edx;
+				__asm__ volatile("xgetbv" : "=a"(eax), "=d"(edx) : "c"(idx));
+				return (static_cast<uint64_t>(edx) << 32) | eax;
+			}
+		}
+#endif
+
+		/**
+		 * \brief Query the CPU (and OS) for the supported vector extensions
+		 *
+		 * The AVX and AVX-512 bits are only reported if the OS saves the
+		 * corresponding register state on a context switch (OSXSAVE+XCR0).
+		 * Off x86, nothing is reported and only the scalar backend is used.
+		 */
+		inline cpu_features detect_features() {
+#if defined(__x86_64__) || defined(__i386__)
+			// The bit_* names in cpuid.h are incomplete before gcc-5, so use the raw bits
+			cpu_features f;
+			unsigned int eax, ebx, ecx, edx;
+
+			if (!__get_cpuid(1, &eax, &ebx, &ecx, &edx)) {
+				return f;
+			}
+			f.sse42 = (ecx & (1u << 20)) != 0;
+
+			bool const osxsave = (ecx & (1u << 27)) != 0;
+			uint64_t const xcr0 = osxsave ? detail::xgetbv(0) : 0;
+			bool const os_ymm = (xcr0 & 0x06) == 0x06;	// XMM | YMM
+			bool const os_zmm = (xcr0 & 0xe6) == 0xe6;	// XMM | YMM | opmask | ZMM
+
+			f.avx = os_ymm && (ecx & (1u << 28)) != 0;
+			f.fma = os_ymm && (ecx & (1u << 12)) != 0;
+
+			if (__get_cpuid_max(0, nullptr) < 7) {
+				return f;
+			}
+			__cpuid_count(7, 0, eax, ebx, ecx, edx);
+			f.avx2     = os_ymm && (ebx & (1u <<  5)) != 0;
+			f.avx512f  = os_zmm && (ebx & (1u << 16)) != 0;
+			f.avx512cd = os_zmm && (ebx & (1u << 28)) != 0;
+			f.avx512er = os_zmm && (ebx & (1u << 27)) != 0;
+			f.avx512pf = os_zmm && (ebx & (1u << 26)) != 0;
+			return f;
+#else
+			return cpu_features{};
+#endif
+		}
+
+		/**
+		 * \brief The best instruction set for the given features
+		 *
+		 * This mirrors the compile-time selection in scimd.hpp.
+		 */
+		inline isa best_isa(cpu_features const& f) {
+			if (f.avx512f && f.avx512er && f.avx512pf) {
+				return isa::knl;
+			}
+			if (f.avx512f) {
+				return isa::avx512;
+			}
+			if (f.avx2 && f.fma) {
+				return isa::avx2;
+			}
+			if (f.avx) {
+				return isa::avx;
+			}
+			if (f.sse42) {
+				return isa::sse;
+			}
+			return isa::scalar;
+		}
+
+		/**
+		 * \brief The instruction set of the running CPU
+		 *
+		 * CPUID is only executed on the first call.
+		 */
+		inline isa active() {
+			static isa const level = best_isa(detect_features());
+			return level;
+		}
+
+		/**
+		 * \brief A function with one implementation per instruction set
+		 *
+		 * The implementation is picked once, at construction, so a call costs
+		 * exactly one indirect call. Dispatch on a block of work (e.g., a whole
+		 * array), not on individual packs.
+		 *
+		 * Each implementation is the same kernel compiled in a separate
+		 * translation unit with different architecture flags. Because scimd
+		 * wraps everything in an ISA-tagged inline namespace, the kernel can
+		 * be placed in `scimd::SCIMD_ISA_NAMESPACE` (or a namespace built
+		 * from it) to give each copy a distinct name:
+		 *
+		 * \code
+		 * 	// kernel.cpp, compiled once each with -msse4.2, -mavx, -mavx2 -mfma
+		 * 	namespace scimd { namespace SCIMD_ISA_NAMESPACE {
+		 * 		void saxpy(float a, float const* x, float* y, size_t n) { ... }
+		 * 	}}
+		 *
+		 * 	// dispatch.cpp, compiled without any architecture flags
+		 * 	static scimd::dispatch::function<void(float, float const*, float*, size_t)>
+		 * 		saxpy{scimd::isa_scalar::saxpy, scimd::isa_sse::saxpy,
+		 * 			  scimd::isa_avx::saxpy, scimd::isa_avx2::saxpy, nullptr};
+		 * \endcode
+		 *
+		 * Any implementation may be `nullptr`; the best available one not
+		 * exceeding the running CPU is used.
+		 */
+		template <typename Sig>
+		class function;
+
+		template <typename R, typename... Args>
+		class function<R(Args...)> {
+		public:
+			using pointer = R (*)(Args...);
+
+			function(pointer scalar, pointer sse, pointer avx, pointer avx2, pointer avx512, pointer knl = nullptr)
+				: function(active(), scalar, sse, avx, avx2, avx512, knl) {}
+
+			function(isa level, pointer scalar, pointer sse, pointer avx, pointer avx2, pointer avx512, pointer knl = nullptr)
+				: impl{nullptr}, selected{level} {
+				pointer const table[] = {scalar, sse, avx, avx2, avx512, knl};
+				for (int i = static_cast<int>(level); i >= 0; i--) {
+					if (table[i]) {
+						impl = table[i];
+						selected = static_cast<isa>(i);
+						return;
+					}
+				}
+				throw std::runtime_error { "No usable implementation for this CPU" };
+			}
+
+			R operator()(Args... args) const { return impl(static_cast<Args>(args)...); }
+
+			/**
+			 * \brief The instruction set of the implementation being called
+			 */
+			isa target() const noexcept { return selected; }
+
+		private:
+			pointer impl;
+			isa selected;
+		};
+	}
+}
@@ -0,0 +1,329 @@
+#pragma once
+
+#include "scimd.hpp"
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+
+/**
+ * 	Array expressions
+ *
+ * 	An array_view refers to a pack-aligned array. Arithmetic on views (and
+ * 	scalars) builds an expression instead of computing anything; assigning
+ * 	the expression to a view evaluates it in one pass, a pack at a time:
+ *
+ * 		array_view<float> a{pa, n}, b{pb, n}, c{pc, n}, d{pd, n};
+ * 		c = a * b + sqrt(d);
+ *
+ * 	loads each of a, b, and d once per pack, stores c once per pack, and
+ * 	has no temporary arrays. A product that feeds an addition or subtraction
+ * 	is fused into fma, fms, or fnma. The last partial pack uses a masked
+ * 	load and store, so the length need not be a multiple of the pack size.
+ *
+ * 	Available are the arithmetic operators, min, max, abs, sqrt, rsqrt, fma,
+ * 	and map(e, f), which applies any function over pack<T> (e.g., exp from
+ * 	math.hpp).
+ *
+ * 	Each element is read before it is written, so the destination may also
+ * 	appear in the expression (e.g., `a = a * a`), but only at the same index.
+ */
+namespace scimd { inline namespace SCIMD_ISA_NAMESPACE {
+	namespace expr {
+		template <typename T>
+		struct is_expression : std::false_type {};
+
+		/*
+		 * 	A scalar operand, broadcast to every element
+		 *
+		 * 	Its size is zero so that it matches any other operand.
+		 */
+		template <typename T>
+		struct scalar {
+			using value_type = T;
+			pack<T> value;
+			explicit scalar(T x) : value{x} {}
+			size_t size() const noexcept { return 0; }
+			pack<T> eval(size_t) const { return value; }
+			pack<T> eval_n(size_t, size_t) const { return value; }
+		};
+		template <typename T>
+		struct is_expression<scalar<T>> : std::true_type {};
+
+		/*
+		 * 	Expressions are stored by value. Views are just a pointer and a size,
+		 * 	and scalars in an expression are wrapped into a scalar node.
+		 */
+		template <typename E, typename T, typename = void>
+		struct operand { using type = E; };
+		template <typename E, typename T>
+		struct operand<E, T, typename std::enable_if<std::is_arithmetic<E>::value>::type> { using type = scalar<T>; };
+
+		template <typename T, typename E>
+		E const& wrap(E const& e, std::true_type) { return e; }
+		template <typename T, typename E>
+		scalar<T> wrap(E x, std::false_type) { return scalar<T>{static_cast<T>(x)}; }
+
+		template <typename E, typename T>
+		typename operand<E, T>::type make_operand(E const& e) {
+			return wrap<T>(e, is_expression<E>{});
+		}
+
+		inline size_t common_size(size_t a, size_t b) {
+			if (a != 0 && b != 0 && a != b) {
+				throw std::invalid_argument { "The arrays in an expression must have the same size" };
+			}
+			return (a != 0) ? a : b;
+		}
+
+		/* ----------------------------------------------------------
+		 * 			Operations
+		 *---------------------------------------------------------*/
+		struct add { template <typename P> static P apply(P x, P y) { return x + y; } };
+		struct sub { template <typename P> static P apply(P x, P y) { return x - y; } };
+		struct mul { template <typename P> static P apply(P x, P y) { return x * y; } };
+		struct div { template <typename P> static P apply(P x, P y) { return x / y; } };
+		struct min_op { template <typename P> static P apply(P x, P y) { return ::min(x, y); } };
+		struct max_op { template <typename P> static P apply(P x, P y) { return ::max(x, y); } };
+
+		struct neg { template <typename P> static P apply(P x) { return -x; } };
+		struct abs_op { template <typename P> static P apply(P x) { return ::abs(x); } };
+		struct rsqrt_op { template <typename P> static P apply(P x) { return ::rsqrt(x); } };
+		struct sqrt_op {
+			template <typename P>
+			static P apply(P x) {
+				return scimd::sqrt(x.val, typename P::value_type{}, typename P::category{});
+			}
+		};
+
+		struct fma_op { template <typename P> static P apply(P a, P b, P c) { return ::fma(a, b, c); } };
+		struct fms_op { template <typename P> static P apply(P a, P b, P c) { return ::fms(a, b, c); } };
+		struct fnma_op { template <typename P> static P apply(P a, P b, P c) { return ::fnma(a, b, c); } };
+
+		/* ----------------------------------------------------------
+		 * 			Nodes
+		 *---------------------------------------------------------*/
+		template <typename Op, typename E>
+		struct unary {
+			using value_type = typename E::value_type;
+			E e;
+			size_t size() const noexcept { return e.size(); }
+			pack<value_type> eval(size_t i) const { return Op::apply(e.eval(i)); }
+			pack<value_type> eval_n(size_t i, size_t n) const { return Op::apply(e.eval_n(i, n)); }
+		};
+		template <typename Op, typename E>
+		struct is_expression<unary<Op, E>> : std::true_type {};
+
+		template <typename Op, typename L, typename R>
+		struct binary {
+			using value_type = typename L::value_type;
+			L l;
+			R r;
+			size_t n;
+			binary(L const& l, R const& r) : l(l), r(r), n{common_size(l.size(), r.size())} {}
+			size_t size() const noexcept { return n; }
+			pack<value_type> eval(size_t i) const { return Op::apply(l.eval(i), r.eval(i)); }
+			pack<value_type> eval_n(size_t i, size_t k) const { return Op::apply(l.eval_n(i, k), r.eval_n(i, k)); }
+		};
+		template <typename Op, typename L, typename R>
+		struct is_expression<binary<Op, L, R>> : std::true_type {};
+
+		template <typename Op, typename A, typename B, typename C>
+		struct ternary {
+			using value_type = typename A::value_type;
+			A a;
+			B b;
+			C c;
+			size_t n;
+			ternary(A const& a, B const& b, C const& c)
+				: a(a), b(b), c(c), n{common_size(common_size(a.size(), b.size()), c.size())} {}
+			size_t size() const noexcept { return n; }
+			pack<value_type> eval(size_t i) const { return Op::apply(a.eval(i), b.eval(i), c.eval(i)); }
+			pack<value_type> eval_n(size_t i, size_t k) const {
+				return Op::apply(a.eval_n(i, k), b.eval_n(i, k), c.eval_n(i, k));
+			}
+		};
+		template <typename Op, typename A, typename B, typename C>
+		struct is_expression<ternary<Op, A, B, C>> : std::true_type {};
+
+		template <typename E, typename F>
+		struct mapped {
+			using value_type = typename E::value_type;
+			E e;
+			F f;
+			size_t size() const noexcept { return e.size(); }
+			pack<value_type> eval(size_t i) const { return f(e.eval(i)); }
+			pack<value_type> eval_n(size_t i, size_t n) const { return f(e.eval_n(i, n)); }
+		};
+		template <typename E, typename F>
+		struct is_expression<mapped<E, F>> : std::true_type {};
+
+		/**
+		 * \brief A non-owning reference to `n` pack-aligned elements
+		 *
+		 * \pre `p` is aligned for pack<T> (e.g., from scimd::allocator)
+		 */
+		template <typename T>
+		class array_view {
+		public:
+			using value_type = T;
+
+			array_view(T* p, size_t n) noexcept : p_{p}, n_{n} {}
+			template <typename Container>
+			explicit array_view(Container& c) noexcept : p_{c.data()}, n_{c.size()} {}
+
+			// Copying a view copies the reference; assigning evaluates
+			array_view(array_view const&) = default;
+			array_view& operator=(array_view const& rhs) { return assign(rhs); }
+
+			template <typename E, typename = typename std::enable_if<is_expression<E>::value>::type>
+			array_view& operator=(E const& e) { return assign(e); }
+			array_view& operator=(T x) { return assign(scalar<T>{x}); }
+
+			template <typename E> array_view& operator+=(E const& e) { return *this = *this + e; }
+			template <typename E> array_view& operator-=(E const& e) { return *this = *this - e; }
+			template <typename E> array_view& operator*=(E const& e) { return *this = *this * e; }
+			template <typename E> array_view& operator/=(E const& e) { return *this = *this / e; }
+
+			T* data() const noexcept { return p_; }
+			size_t size() const noexcept { return n_; }
+			T& operator[](size_t i) const noexcept { return p_[i]; }
+
+			pack<T> eval(size_t i) const {
+				pack<T> x;
+				x.load(memory::aligned{}, p_ + i);
+				return x;
+			}
+			pack<T> eval_n(size_t i, size_t n) const {
+				pack<T> x;
+				x.load_n(p_ + i, n);
+				return x;
+			}
+
+		private:
+			T* p_;
+			size_t n_;
+
+			template <typename E>
+			array_view& assign(E const& e) {
+				constexpr size_t N = pack<T>::size;
+				common_size(n_, e.size());
+				size_t const full = n_ - n_ % N;
+				for (size_t i = 0; i < full; i += N) {
+					e.eval(i).store(memory::aligned{}, p_ + i);
+				}
+				if (full < n_) {
+					e.eval_n(full, n_ - full).store_n(p_ + full, n_ - full);
+				}
+				return *this;
+			}
+		};
+		template <typename T>
+		struct is_expression<array_view<T>> : std::true_type {};
+
+		/* ----------------------------------------------------------
+		 * 			Operators
+		 *
+		 * 	At least one operand must be an expression; the other may
+		 * 	be an arithmetic scalar.
+		 *---------------------------------------------------------*/
+		template <typename L, typename R>
+		struct value_type_of {
+			using type = typename std::conditional<is_expression<L>::value, L, R>::type::value_type;
+		};
+
+		template <typename Op, typename L, typename R>
+		using binary_t = typename std::enable_if<
+							(is_expression<L>::value && (is_expression<R>::value || std::is_arithmetic<R>::value)) ||
+							(is_expression<R>::value && std::is_arithmetic<L>::value),
+							binary<Op,
+								   typename operand<L, typename value_type_of<L, R>::type>::type,
+								   typename operand<R, typename value_type_of<L, R>::type>::type>
+						 >::type;
+
+		template <typename Op, typename L, typename R>
+		binary_t<Op, L, R> make_binary(L const& l, R const& r) {
+			using T = typename value_type_of<L, R>::type;
+			return {make_operand<L, T>(l), make_operand<R, T>(r)};
+		}
+
+		template <typename L, typename R>
+		binary_t<add, L, R> operator+(L const& l, R const& r) { return make_binary<add>(l, r); }
+		template <typename L, typename R>
+		binary_t<sub, L, R> operator-(L const& l, R const& r) { return make_binary<sub>(l, r); }
+		template <typename L, typename R>
+		binary_t<mul, L, R> operator*(L const& l, R const& r) { return make_binary<mul>(l, r); }
+		template <typename L, typename R>
+		binary_t<div, L, R> operator/(L const& l, R const& r) { return make_binary<div>(l, r); }
+		template <typename L, typename R>
+		binary_t<min_op, L, R> min(L const& l, R const& r) { return make_binary<min_op>(l, r); }
+		template <typename L, typename R>
+		binary_t<max_op, L, R> max(L const& l, R const& r) { return make_binary<max_op>(l, r); }
+
+		/*
+		 * 	Fuse a product into the addition or subtraction it feeds
+		 *
+		 * 		a*b + c -> fma(a, b, c)		c + a*b -> fma(a, b, c)
+		 * 		a*b - c -> fms(a, b, c)		c - a*b -> fnma(a, b, c)
+		 *
+		 * 	When both operands are products, the left one is fused.
+		 */
+		template <typename Op, typename A, typename B, typename R>
+		using fused_t = typename std::enable_if<
+							is_expression<R>::value || std::is_arithmetic<R>::value,
+							ternary<Op, A, B, typename operand<R, typename A::value_type>::type>
+						>::type;
+
+		template <typename A, typename B, typename R>
+		fused_t<fma_op, A, B, R> operator+(binary<mul, A, B> const& p, R const& r) {
+			return {p.l, p.r, make_operand<R, typename A::value_type>(r)};
+		}
+		template <typename L, typename A, typename B>
+		fused_t<fma_op, A, B, L> operator+(L const& l, binary<mul, A, B> const& p) {
+			return {p.l, p.r, make_operand<L, typename A::value_type>(l)};
+		}
+		template <typename A, typename B, typename C, typename D>
+		ternary<fma_op, A, B, binary<mul, C, D>> operator+(binary<mul, A, B> const& p, binary<mul, C, D> const& q) {
+			return {p.l, p.r, q};
+		}
+		template <typename A, typename B, typename R>
+		fused_t<fms_op, A, B, R> operator-(binary<mul, A, B> const& p, R const& r) {
+			return {p.l, p.r, make_operand<R, typename A::value_type>(r)};
+		}
+		template <typename L, typename A, typename B>
+		fused_t<fnma_op, A, B, L> operator-(L const& l, binary<mul, A, B> const& p) {
+			return {p.l, p.r, make_operand<L, typename A::value_type>(l)};
+		}
+		template <typename A, typename B, typename C, typename D>
+		ternary<fms_op, A, B, binary<mul, C, D>> operator-(binary<mul, A, B> const& p, binary<mul, C, D> const& q) {
+			return {p.l, p.r, q};
+		}
+
+		template <typename A, typename B, typename C>
+		typename std::enable_if<
+			is_expression<A>::value && is_expression<B>::value && is_expression<C>::value,
+			ternary<fma_op, A, B, C>
+		>::type fma(A const& a, B const& b, C const& c) { return {a, b, c}; }
+
+		template <typename E>
+		typename std::enable_if<is_expression<E>::value, unary<neg, E>>::type
+		operator-(E const& e) { return {e}; }
+		template <typename E>
+		typename std::enable_if<is_expression<E>::value, unary<sqrt_op, E>>::type
+		sqrt(E const& e) { return {e}; }
+		template <typename E>
+		typename std::enable_if<is_expression<E>::value, unary<rsqrt_op, E>>::type
+		rsqrt(E const& e) { return {e}; }
+		template <typename E>
+		typename std::enable_if<is_expression<E>::value, unary<abs_op, E>>::type
+		abs(E const& e) { return {e}; }
+
+		/**
+		 * \brief Apply `f`, a function from pack<T> to pack<T>, to each element
+		 */
+		template <typename E, typename F>
+		typename std::enable_if<is_expression<E>::value, mapped<E, F>>::type
+		map(E const& e, F f) { return {e, f}; }
+	}
+
+	using expr::array_view;
+}}
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "scimd.hpp"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/**
+ * 	Indirect access with software prefetching
+ *
+ * 	Loops that load through an index array (e.g., over a neighbour list)
+ * 	stall on every gather whose lines are not in cache, and the hardware
+ * 	prefetchers cannot predict the addresses. for_each_indirect gathers
+ * 	one pack at a time and prefetches the elements that the pack
+ * 	`distance` packs ahead will gather, so they arrive in time.
+ *
+ * 	The best distance covers the memory latency with the work of the loop
+ * 	body: too short and the loads still stall, too long and the lines are
+ * 	evicted before use. It depends on the machine and the body, so it is
+ * 	a parameter (see the `indirect` entries of the benchmark).
+ */
+namespace scimd { inline namespace SCIMD_ISA_NAMESPACE {
+
+	namespace detail {
+		template <typename T, typename... Ts>
+		struct all_same : std::true_type {};
+		template <typename T, typename U, typename... Ts>
+		struct all_same<T, U, Ts...>
+			: std::integral_constant<bool, std::is_same<T, U>::value && all_same<T, Ts...>::value> {};
+
+		inline void prefetch_each(int32_t) {}
+		template <typename T, typename... Ts>
+		void prefetch_each(int32_t i, T const* base, Ts const*... bases) {
+			scimd::prefetch<1>(base + i);
+			prefetch_each(i, bases...);
+		}
+
+		// base[index[0]], ..., base[index[n - 1]], then zeros
+		template <typename T>
+		pack<T> gather_n(T const* base, int32_t const* index, size_t n) {
+			constexpr size_t N = pack<T>::size;
+			alignas(pack<T>) T values[N];
+			for (size_t i = 0; i < N; i++) {
+				values[i] = (i < n) ? base[index[i]] : T{0};
+			}
+			pack<T> x;
+			x.load(memory::aligned{}, values);
+			return x;
+		}
+	}
+
+	/**
+	 * \brief Call f(i, x...) for each pack of `index`
+	 *
+	 * For each i in [0, n) in steps of pack<T>::size, `x` is gathered from
+	 * `base` (and each of `bases`) at `index[i]` through `index[i + size - 1]`.
+	 * In the last pack, the lanes at or beyond `n` are zero.
+	 *
+	 * Before each gather, the elements indexed `distance` packs ahead are
+	 * prefetched into L1. A distance of zero disables prefetching.
+	 */
+	template <typename F, typename T, typename... Ts>
+	void for_each_indirect(int32_t const* index, size_t n, size_t distance, F f, T const* base, Ts const*... bases) {
+		static_assert(detail::all_same<T, Ts...>::value, "All arrays must have the same type");
+		constexpr size_t N = pack<T>::size;
+		size_t const full = n - n % N;
+		size_t const ahead = distance * N;
+
+		for (size_t i = 0; i < full; i += N) {
+			if (ahead != 0) {
+				size_t const last = std::min(n, i + ahead + N);
+				for (size_t j = i + ahead; j < last; j++) {
+					detail::prefetch_each(index[j], base, bases...);
+				}
+			}
+			index_pack<T> idx;
+			idx.load(index + i);
+			f(i, ::gather(base, idx), ::gather(bases, idx)...);
+		}
+		if (full < n) {
+			f(full, detail::gather_n(base, index + full, n - full), detail::gather_n(bases, index + full, n - full)...);
+		}
+	}
+}}
@@ -0,0 +1,955 @@
+#pragma once
+
+#include "scimd.hpp"
+#include <cmath>
+#include <cstdint>
+#include <limits>
+
+/**
+ * 	Vectorized exponential, logarithmic, and trigonometric functions
+ *
+ * 	Each function reduces its argument to a small interval around zero,
+ * 	evaluates a minimax polynomial (or rational function) there, and then
+ * 	undoes the reduction. The single-precision coefficients are those of
+ * 	the Cephes library by Stephen L. Moshier; the double-precision ones
+ * 	come from fdlibm or Cephes, as noted at each kernel.
+ *
+ * 	The maximum errors, measured against a long double reference over the
+ * 	full domain on every backend, are
+ *
+ * 					float		double
+ * 		exp			1 ULP		1 ULP
+ * 		expm1		2 ULP		2 ULP
+ * 		exp2		1 ULP		1 ULP
+ * 		log			1 ULP		1 ULP
+ * 		log1p		1.5 ULP		1.5 ULP
+ * 		log2		1.5 ULP		1.5 ULP
+ * 		pow			1.5 ULP		1.5 ULP
+ * 		sin, cos	2.5 ULP		2.5 ULP
+ * 		tan			3.5 ULP		3 ULP
+ * 		asin		2.5 ULP		2.5 ULP
+ * 		acos		1.5 ULP		1.5 ULP
+ * 		atan		2.5 ULP		1 ULP
+ * 		atan2		3 ULP		1.5 ULP
+ *
+ * 	The error of log2(x) in pow is multiplied by y, so pow carries log2(x)
+ * 	in double-word precision. Its bound holds for every |y*log2(x)| up to
+ * 	the overflow and underflow thresholds. Without FMA hardware the
+ * 	extra-precise products are formed with Dekker's algorithm, so the
+ * 	bounds are the same but pow is roughly twice as expensive.
+ *
+ * 	Special values (NaN, +-inf, +-0, and arguments outside the domain)
+ * 	follow C99 Annex F, except that
+ *
+ * 		- pow(-0, y) for odd y returns +0 or +inf
+ * 		- the sign of zero results of expm1, log1p, sin, tan, and atan
+ * 		  is not preserved
+ * 		- atan2 treats -0 as +0
+ */
+namespace scimd {
+	namespace range {
+		/**
+		 * \brief Argument range of the trigonometric functions
+		 *
+		 * full: Any argument. Lanes beyond the limit of the Cody-Waite
+		 * 		 reduction are reduced one at a time with Payne-Hanek.
+		 *
+		 * limited: The caller guarantees |x| <= 8192 (float) or |x| <= 2^20
+		 * 			(double). This skips the check for large arguments.
+		 * 			Larger arguments give meaningless results.
+		 */
+		struct full{};
+		struct limited{};
+	}
+}
+
+namespace scimd { inline namespace SCIMD_ISA_NAMESPACE {
+	namespace detail {
+		template <typename T>
+		inline pack<T> round(pack<T> x) { return ::scimd::round(x.val, T{}, typename pack<T>::category{}); }
+		template <typename T>
+		inline pack<T> ldexp(pack<T> x, pack<T> n) { return ::scimd::ldexp(x.val, n.val, T{}, typename pack<T>::category{}); }
+		template <typename T>
+		inline pack<T> getexp(pack<T> x) { return ::scimd::getexp(x.val, T{}, typename pack<T>::category{}); }
+		template <typename T>
+		inline pack<T> getmant(pack<T> x) { return ::scimd::getmant(x.val, T{}, typename pack<T>::category{}); }
+		template <typename T>
+		inline pack<T> sqrt(pack<T> x) { return ::scimd::sqrt(x.val, T{}, typename pack<T>::category{}); }
+
+		template <typename T, size_t N>
+		inline pack<T> horner(pack<T> x, T const (&c)[N]) {
+			pack<T> r{c[0]};
+			for (size_t i = 1; i < N; i++) {
+				r = ::fma(r, x, pack<T>{c[i]});
+			}
+			return r;
+		}
+
+		/**
+		 * 	The rounding error of a*b such that a*b = p + err exactly
+		 */
+		template <typename T>
+		inline pack<T> two_prod_err(pack<T> a, pack<T> b, pack<T> p, std::true_type) {
+			return ::fms(a, b, p);
+		}
+		template <typename T>
+		inline pack<T> two_prod_err(pack<T> a, pack<T> b, pack<T> p, std::false_type) {
+			// Dekker's product using Veltkamp's splitting
+			pack<T> const split{static_cast<T>((sizeof(T) == 4) ? 4097.0 : 134217729.0)};
+			pack<T> const ta = split * a, tb = split * b;
+			pack<T> const ah = ta - (ta - a), al = a - ah;
+			pack<T> const bh = tb - (tb - b), bl = b - bh;
+			return ((ah * bh - p) + ah * bl + al * bh) + al * bl;
+		}
+		template <typename T>
+		inline pack<T> two_prod_err(pack<T> a, pack<T> b, pack<T> p) {
+			return two_prod_err(a, b, p, has_fma<typename pack<T>::category>{});
+		}
+
+		template <typename T>
+		struct exp_limits;
+
+		template <>
+		struct exp_limits<float> {
+			static constexpr float ln2_hi = 0.693359375f, ln2_lo = -2.12194440e-4f;
+			static constexpr float max_log = 88.72283905f, min_log = -103.972084f;
+			static constexpr float max_exp2 = 128.0f, min_exp2 = -150.0f;
+			static constexpr float max_exp = 127.0f;
+			static constexpr float log2e = 1.44269502f, log2e_lo = 1.92596299e-8f;
+			static constexpr float min_normal = 1.17549435e-38f, subnormal_scale = 16777216.0f, subnormal_bits = 24.0f;
+			static constexpr float two_thirds = 0.666666687f, two_thirds_lo = -1.98682149e-8f;
+		};
+		template <>
+		struct exp_limits<double> {
+			static constexpr double ln2_hi = 6.93145751953125E-1, ln2_lo = 1.42860682030941723212E-6;
+			static constexpr double max_log = 7.09782712893383996843E2, min_log = -7.45133219101941108420E2;
+			static constexpr double max_exp2 = 1024.0, min_exp2 = -1075.0;
+			static constexpr double max_exp = 1023.0;
+			static constexpr double log2e = 1.4426950408889634, log2e_lo = 2.0355273740931033e-17;
+			static constexpr double min_normal = 2.2250738585072014e-308, subnormal_scale = 18014398509481984.0, subnormal_bits = 54.0;
+			static constexpr double two_thirds = 0.66666666666666663, two_thirds_lo = 3.700743415417188e-17;
+		};
+
+		/**
+		 * 	e^r - 1 for |r| <= ln(2)/2
+		 */
+		inline pack<float> expm1_kernel(pack<float> r) {
+			static const float c[] = {
+				1.9875691500E-4f, 1.3981999507E-3f, 8.3334519073E-3f,
+				4.1665795894E-2f, 1.6666665459E-1f, 5.0000001201E-1f
+			};
+			return ::fma(horner(r, c), r * r, r);
+		}
+		inline pack<double> expm1_kernel(pack<double> r) {
+			// Taylor series through r^14; the truncation error is below 2^-56
+			static const double c[] = {
+				1.0/87178291200.0, 1.0/6227020800.0, 1.0/479001600.0, 1.0/39916800.0,
+				1.0/3628800.0, 1.0/362880.0, 1.0/40320.0, 1.0/5040.0, 1.0/720.0,
+				1.0/120.0, 1.0/24.0, 1.0/6.0, 1.0/2.0
+			};
+			return ::fma(horner(r, c), r * r, r);
+		}
+
+		/**
+		 * 	Split x = r + n*ln(2) with |r| <= ln(2)/2 (Cody-Waite)
+		 */
+		template <typename T>
+		inline pack<T> reduce_ln2(pack<T> x, pack<T>& n) {
+			n = round(x * pack<T>{exp_limits<T>::log2e});
+			pack<T> r = ::fnma(n, pack<T>{exp_limits<T>::ln2_hi}, x);
+			return ::fnma(n, pack<T>{exp_limits<T>::ln2_lo}, r);
+		}
+
+		/**
+		 * 	log(1 + f) - f for sqrt(1/2)-1 <= f <= sqrt(2)-1
+		 */
+		inline pack<float> log1p_kernel(pack<float> f) {
+			static const float c[] = {
+				7.0376836292E-2f, -1.1514610310E-1f, 1.1676998740E-1f,
+				-1.2420140846E-1f, 1.4249322787E-1f, -1.6668057665E-1f,
+				2.0000714765E-1f, -2.4999993993E-1f, 3.3333331174E-1f
+			};
+			pack<float> const z = f * f;
+			return ::fnma(pack<float>{0.5f}, z, horner(f, c) * f * z);
+		}
+		inline pack<double> log1p_kernel(pack<double> f) {
+			// log(1 + f) = 2*atanh(s) with s = f/(2 + f) (from fdlibm's e_log.c)
+			static const double c[] = {
+				1.479819860511658591e-01, 1.531383769920937332e-01, 1.818357216161805012e-01,
+				2.222219843214978396e-01, 2.857142874366239149e-01, 3.999999999940941908e-01,
+				6.666666666666735130e-01
+			};
+			pack<double> const s = f / (pack<double>{2.0} + f);
+			pack<double> const z = s * s;
+			pack<double> const hfsq = pack<double>{0.5} * f * f;
+			return ::fms(s, hfsq + z * horner(z, c), hfsq);
+		}
+
+		/**
+		 * 	Split x = (1 + f) * 2^e with sqrt(1/2) <= 1 + f < sqrt(2)
+		 *
+		 * 	Assumes x is positive and finite.
+		 */
+		template <typename T>
+		inline pack<T> reduce_log(pack<T> x, pack<T>& e) {
+			using P = pack<T>;
+			using L = exp_limits<T>;
+			auto const subnormal = x < P{L::min_normal};
+			x.blend(x * P{L::subnormal_scale}, subnormal);
+			e = getexp(x);
+			e.blend(e - P{L::subnormal_bits}, subnormal);
+
+			P m = getmant(x);
+			auto const high = m > P{static_cast<T>(1.41421356237309504880)};
+			m.blend(m * P{static_cast<T>(0.5)}, high);
+			e.blend(e + P{static_cast<T>(1.0)}, high);
+			return m - P{static_cast<T>(1.0)};
+		}
+
+		/**
+		 * 	Replace the result for x outside of (0, inf)
+		 */
+		template <typename T>
+		inline pack<T> log_special(pack<T> result, pack<T> x) {
+			using P = pack<T>;
+			// Propagate NaN inputs (x - x is zero for finite x)
+			result += x - x;
+			result.blend(x, x > P{std::numeric_limits<T>::max()});
+			result.blend(P{-std::numeric_limits<T>::infinity()}, x <= P{static_cast<T>(0.0)});
+			result.blend(P{std::numeric_limits<T>::quiet_NaN()}, x < P{static_cast<T>(0.0)});
+			return result;
+		}
+
+		/**
+		 * 	2*atanh(s) - 2*s - (2/3)*s^3 = s^5 * atanh_tail(s^2) for |s| <= 3 - 2*sqrt(2)
+		 *
+		 * 	Taylor series, truncated below 2^-35 (float) or 2^-67 (double)
+		 * 	relative to log(1 + f).
+		 */
+		inline pack<float> atanh_tail(pack<float> z) {
+			static const float c[] = {2.0f/11.0f, 2.0f/9.0f, 2.0f/7.0f, 2.0f/5.0f};
+			return horner(z, c);
+		}
+		inline pack<double> atanh_tail(pack<double> z) {
+			static const double c[] = {
+				2.0/25.0, 2.0/23.0, 2.0/21.0, 2.0/19.0, 2.0/17.0, 2.0/15.0,
+				2.0/13.0, 2.0/11.0, 2.0/9.0, 2.0/7.0, 2.0/5.0
+			};
+			return horner(z, c);
+		}
+
+		/**
+		 * 	(ah + al) * (bh + bl) as an unevaluated sum hi + lo
+		 */
+		template <typename T>
+		inline pack<T> mul_hilo(pack<T> ah, pack<T> al, pack<T> bh, pack<T> bl, pack<T>& lo) {
+			pack<T> const hi = ah * bh;
+			lo = two_prod_err(ah, bh, hi) + ::fma(ah, bl, al * bh);
+			return hi;
+		}
+
+		/**
+		 * 	log2(x) as an unevaluated sum hi + lo
+		 *
+		 * 	The extra precision is needed by pow: y*log2(x) must be accurate to
+		 * 	about 2^-p absolute (p is the precision of T) for |y*log2(x)| up to
+		 * 	the exponent range. With x = (1 + f) * 2^e, log(1 + f) = 2*atanh(s)
+		 * 	for s = f/(2 + f), and the leading terms 2*s and (2/3)*s^3 are
+		 * 	carried in double-word arithmetic. Assumes x is positive and finite.
+		 */
+		template <typename T>
+		inline pack<T> log2_hilo(pack<T> x, pack<T>& lo) {
+			using P = pack<T>;
+			P const one{static_cast<T>(1.0)}, two{static_cast<T>(2.0)};
+			P e;
+			P const f = reduce_log(x, e);
+
+			// u = 2 + f = 1 + m; Fast2Sum is exact since m < 2
+			P const m = f + one;
+			P const u = one + m;
+			P const u_lo = m - (u - one);
+
+			// s = f / u; f - s*u is exact (Sterbenz) except for the product's rounding
+			P const s = f / u;
+			P const su = s * u;
+			P const s_lo = (((f - su) - two_prod_err(s, u, su)) - s * u_lo) / u;
+
+			// w = s^3 * (2/3 + s^2 * tail(s^2))
+			P z_lo;
+			P const z = mul_hilo(s, s_lo, s, s_lo, z_lo);
+			P const q = z * atanh_tail(z);
+			P const two_thirds{exp_limits<T>::two_thirds}, two_thirds_lo{exp_limits<T>::two_thirds_lo};
+			P const c = two_thirds + q;
+			P const c_lo = ((two_thirds - c) + q) + two_thirds_lo;
+			P s3_lo;
+			P const s3 = mul_hilo(s, s_lo, z, z_lo, s3_lo);
+			P w_lo;
+			P const w = mul_hilo(s3, s3_lo, c, c_lo, w_lo);
+
+			// log(1 + f) = 2*s + w; |2*s| > |w|, so Fast2Sum is exact
+			P const l = ::fma(two, s, w);
+			P const l_lo = ((two * s - l) + w) + ::fma(two, s_lo, w_lo);
+
+			// log2(1 + f) = log(1 + f) * log2(e)
+			P t_lo;
+			P const t = mul_hilo(l, l_lo, P{exp_limits<T>::log2e}, P{exp_limits<T>::log2e_lo}, t_lo);
+
+			// |e| >= 1 > |t| unless e is 0, so Fast2Sum is exact
+			P const sum = e + t;
+			P const sum_err = (t - (sum - e)) + t_lo;
+
+			// Renormalize so that lo is below the precision of hi
+			P const hi = sum + sum_err;
+			lo = sum_err - (hi - sum);
+			return hi;
+		}
+
+		template <typename T>
+		struct trig_limits;
+
+		template <>
+		struct trig_limits<float> {
+			static constexpr float two_over_pi = 0.636619772367581343f;
+			static constexpr float pio2_1 = 1.5703125f, pio2_2 = 4.837512969970703125e-4f;
+			static constexpr float pio2_3 = 7.54953362047672271729e-8f, pio2_4 = 2.56334406825708960298e-12f;
+			static constexpr float max_reduce = 8192.0f;
+			static constexpr float pio2_hi = 1.57079637050628662109f, pio2_lo = -4.37113900018624283e-8f;
+			static constexpr float atan_mid = 0.414213562373095049f, atan_high = 2.41421356237309504880f;
+		};
+		template <>
+		struct trig_limits<double> {
+			static constexpr double two_over_pi = 6.36619772367581382433e-01;
+			static constexpr double pio2_1 = 1.57079632673412561417e+00, pio2_2 = 6.07710050630396597660e-11;
+			static constexpr double pio2_3 = 2.02226624871116645580e-21, pio2_4 = 8.47842766036889956997e-32;
+			static constexpr double max_reduce = 1048576.0;
+			static constexpr double pio2_hi = 1.57079632679489655800e+00, pio2_lo = 6.12323399573676603587e-17;
+			static constexpr double atan_mid = 0.66, atan_high = 2.41421356237309504880;
+		};
+
+		/**
+		 * 	x - n*pi/2 (Cody-Waite)
+		 *
+		 * 	Each of the first three parts of pi/2 has enough trailing zeros
+		 * 	that n times it is exact for |x| up to trig_limits::max_reduce.
+		 */
+		template <typename T>
+		inline pack<T> reduce_pio2(pack<T> x, pack<T> n) {
+			using L = trig_limits<T>;
+			pack<T> r = ::fnma(n, pack<T>{L::pio2_1}, x);
+			r = ::fnma(n, pack<T>{L::pio2_2}, r);
+			r = ::fnma(n, pack<T>{L::pio2_3}, r);
+			return ::fnma(n, pack<T>{L::pio2_4}, r);
+		}
+
+		/**
+		 * 	x - q*pi/2 (mod 2*pi) for any finite x (Payne-Hanek)
+		 *
+		 * 	The quadrant q is in [0, 3] and the remainder is in [-pi/4, pi/4].
+		 * 	x*(2/pi) is formed exactly enough by multiplying the 53-bit
+		 * 	significand of x by a 256-bit window of the bits of 2/pi; the bits
+		 * 	before the window only contribute multiples of 4. The window is wide
+		 * 	enough to survive the worst-case cancellation (about 60 bits) for
+		 * 	double arguments.
+		 */
+		inline int rem_pio2_large(double x, double& r) {
+			// 2/pi to 1280 bits
+			static const uint32_t two_over_pi[] = {
+				0xa2f9836e, 0x4e441529, 0xfc2757d1, 0xf534ddc0, 0xdb629599, 0x3c439041,
+				0xfe5163ab, 0xdebbc561, 0xb7246e3a, 0x424dd2e0, 0x06492eea, 0x09d1921c,
+				0xfe1deb1c, 0xb129a73e, 0xe88235f5, 0x2ebb4484, 0xe99c7026, 0xb45f7e41,
+				0x3991d639, 0x835339f4, 0x9c845f8b, 0xbdf9283b, 0x1ff897ff, 0xde05980f,
+				0xef2f118b, 0x5a0a6d1f, 0x6d367ecf, 0x27cb09b7, 0x4f463f66, 0x9e5fea2d,
+				0x7527bac7, 0xebe5f17b, 0x3d0739f7, 0x8a5292ea, 0x6bfb5fb1, 0x1f8d5d08,
+				0x56033046, 0xfc7b6bab, 0xf0cfbc20, 0x9af4361d
+			};
+
+			if (!std::isfinite(x)) {
+				r = x - x;
+				return 0;
+			}
+
+			// |x| = m * 2^e
+			int exponent;
+			uint64_t const m = static_cast<uint64_t>(std::ldexp(std::frexp(std::abs(x), &exponent), 53));
+			int const e = exponent - 53;
+
+			// The first word of 2/pi whose bits can affect x*(2/pi) mod 4
+			int const k0 = (e > 2) ? (e - 2) / 32 : 0;
+
+			// m times the window, least significant limb first
+			constexpr int words = 8;
+			uint32_t const a[2] = {static_cast<uint32_t>(m), static_cast<uint32_t>(m >> 32)};
+			uint32_t p[words + 4] = {};
+			for (int i = 0; i < 2; i++) {
+				uint64_t carry = 0;
+				for (int j = 0; j < words; j++) {
+					uint64_t const t = uint64_t{a[i]} * two_over_pi[k0 + words - 1 - j] + p[i + j] + carry;
+					p[i + j] = static_cast<uint32_t>(t);
+					carry = t >> 32;
+				}
+				p[i + words] = static_cast<uint32_t>(carry);
+			}
+
+			// 64 bits of the product starting at bit 'lo'
+			auto const bits = [&p](int lo) {
+				int const w = lo / 32, b = lo % 32;
+				uint64_t v = (p[w] >> b) | (uint64_t{p[w + 1]} << (32 - b));
+				if (b) {
+					v |= uint64_t{p[w + 2]} << (64 - b);
+				}
+				return v;
+			};
+
+			// The binary point is 's' bits from the bottom of the product
+			int const s = 32 * (k0 + words) - e;
+			int q = static_cast<int>(bits(s) & 3);
+			uint64_t hi = bits(s - 64), lo = bits(s - 128);
+
+			// Round to the nearest quadrant, leaving a fraction in [-1/2, 1/2)
+			bool const negate = (hi >> 63) != 0;
+			if (negate) {
+				hi = ~hi;
+				lo = ~lo + 1;
+				hi += (lo == 0);
+				q++;
+			}
+
+			// Normalize the 128-bit fraction and split it into two doubles
+			int shift = 0;
+			if (hi == 0) {
+				hi = lo;
+				lo = 0;
+				shift = 64;
+			}
+			if (hi == 0) {
+				r = 0.0;
+			} else {
+				int const lz = __builtin_clzll(hi);
+				if (lz) {
+					hi = (hi << lz) | (lo >> (64 - lz));
+					lo <<= lz;
+				}
+				shift += lz;
+				double const f_hi = std::ldexp(static_cast<double>(hi >> 11), -53 - shift);
+				double const f_lo = std::ldexp(static_cast<double>(((hi & 0x7ff) << 42) | (lo >> 22)), -106 - shift);
+
+				// (f_hi + f_lo) * pi/2 in double-double
+				double const pio2_hi = trig_limits<double>::pio2_hi, pio2_lo = trig_limits<double>::pio2_lo;
+				double const prod = f_hi * pio2_hi;
+				r = prod + (std::fma(f_hi, pio2_hi, -prod) + (f_hi * pio2_lo + f_lo * pio2_hi));
+			}
+			if (negate) {
+				r = -r;
+			}
+			if (x < 0.0) {
+				r = -r;
+				q = -q;
+			}
+			return q & 3;
+		}
+
+		/**
+		 * 	Split x = r + q*pi/2 with |r| <= pi/4 and q in [0, 3]
+		 */
+		template <typename T>
+		inline pack<T> reduce_quadrant(pack<T> x, pack<T>& q, range::limited) {
+			using P = pack<T>;
+			P const n = round(x * P{trig_limits<T>::two_over_pi});
+			// n mod 4; n/4 - 3/8 is exact and at least 1/8 from a rounding boundary
+			q = ::fnma(P{static_cast<T>(4.0)}, round(::fms(n, P{static_cast<T>(0.25)}, P{static_cast<T>(0.375)})), n);
+			return reduce_pio2(x, n);
+		}
+		template <typename T>
+		inline pack<T> reduce_quadrant(pack<T> x, pack<T>& q, range::full) {
+			using P = pack<T>;
+			constexpr size_t N = P::size;
+			P r = reduce_quadrant(x, q, range::limited{});
+			if (::any(::abs(x) > P{trig_limits<T>::max_reduce})) {
+				T xs[N], qs[N], rs[N];
+				x.store(xs);
+				q.store(qs);
+				r.store(rs);
+				for (size_t i = 0; i < N; i++) {
+					if (!(std::abs(xs[i]) <= trig_limits<T>::max_reduce)) {
+						double rem;
+						qs[i] = static_cast<T>(rem_pio2_large(xs[i], rem));
+						rs[i] = static_cast<T>(rem);
+					}
+				}
+				q.load(qs);
+				r.load(rs);
+			}
+			return r;
+		}
+
+		/**
+		 * 	sin(r) and cos(r) for |r| <= pi/4
+		 */
+		inline pack<float> sin_kernel(pack<float> r) {
+			static const float c[] = {-1.9515295891E-4f, 8.3321608736E-3f, -1.6666654611E-1f};
+			pack<float> const z = r * r;
+			return ::fma(horner(z, c) * z, r, r);
+		}
+		inline pack<double> sin_kernel(pack<double> r) {
+			// From fdlibm's k_sin.c
+			static const double c[] = {
+				1.58969099521155010221e-10, -2.50507602534068634195e-08, 2.75573137070700676789e-06,
+				-1.98412698298579493134e-04, 8.33333333332248946124e-03, -1.66666666666666324348e-01
+			};
+			pack<double> const z = r * r;
+			return ::fma(horner(z, c), z * r, r);
+		}
+		template <typename T, size_t N>
+		inline pack<T> cos_kernel(pack<T> r, T const (&c)[N]) {
+			// 1 - z/2 rounds to w; the rounding error is added back in
+			using P = pack<T>;
+			P const one{static_cast<T>(1.0)};
+			P const z = r * r;
+			P const hz = z * P{static_cast<T>(0.5)};
+			P const w = one - hz;
+			return w + (((one - w) - hz) + z * z * horner(z, c));
+		}
+		inline pack<float> cos_kernel(pack<float> r) {
+			static const float c[] = {2.443315711809948E-5f, -1.388731625493765E-3f, 4.166664568298827E-2f};
+			return cos_kernel(r, c);
+		}
+		inline pack<double> cos_kernel(pack<double> r) {
+			// From fdlibm's k_cos.c
+			static const double c[] = {
+				-1.13596475577881948265e-11, 2.08757232129817482790e-09, -2.75573143513906633035e-07,
+				2.48015872894767294178e-05, -1.38888888888741095749e-03, 4.16666666666666019037e-02
+			};
+			return cos_kernel(r, c);
+		}
+
+		/**
+		 * 	tan(r) for |r| <= pi/4
+		 */
+		inline pack<float> tan_kernel(pack<float> r) {
+			static const float c[] = {
+				9.38540185543E-3f, 3.11992232697E-3f, 2.44301354525E-2f,
+				5.34112807005E-2f, 1.33387994085E-1f, 3.33331568548E-1f
+			};
+			pack<float> const z = r * r;
+			return ::fma(horner(z, c) * z, r, r);
+		}
+		inline pack<double> tan_kernel(pack<double> r) {
+			// From Cephes' tan.c
+			static const double p[] = {-1.30936939181383777646E4, 1.15351664838587416140E6, -1.79565251976484877988E7};
+			static const double q[] = {
+				1.0, 1.36812963470692954678E4, -1.32089234440210967447E6,
+				2.50083801823357915839E7, -5.38695755929454629881E7
+			};
+			pack<double> const z = r * r;
+			return ::fma(z * horner(z, p) / horner(z, q), r, r);
+		}
+
+		/**
+		 * 	sin(x) given the quadrant of x and the sine and cosine of its remainder
+		 */
+		template <typename T>
+		inline pack<T> sin_quadrant(pack<T> q, pack<T> s, pack<T> c) {
+			using P = pack<T>;
+			P result = s;
+			result.blend(c, q > P{static_cast<T>(0.5)});
+			result.blend(-s, q > P{static_cast<T>(1.5)});
+			result.blend(-c, q > P{static_cast<T>(2.5)});
+			return result;
+		}
+
+		/**
+		 * 	asin(t) for |t| <= 1/2, given z = t*t
+		 */
+		inline pack<float> asin_kernel(pack<float> t, pack<float> z) {
+			static const float c[] = {
+				4.2163199048E-2f, 2.4181311049E-2f, 4.5470025998E-2f,
+				7.4953002686E-2f, 1.6666752422E-1f
+			};
+			return ::fma(horner(z, c) * z, t, t);
+		}
+		inline pack<double> asin_kernel(pack<double> t, pack<double> z) {
+			// From fdlibm's e_asin.c
+			static const double p[] = {
+				3.47933107596021167570e-05, 7.91534994289814532176e-04, -4.00555345006794114027e-02,
+				2.01212532134862925881e-01, -3.25565818622400915405e-01, 1.66666666666666657415e-01
+			};
+			static const double q[] = {
+				7.70381505559019352791e-02, -6.88283971605453293030e-01, 2.02094576023350569471e+00,
+				-2.40339491173441421878e+00, 1.0
+			};
+			return ::fma(z * horner(z, p) / horner(z, q), t, t);
+		}
+
+		/**
+		 * 	Prepare the argument of asin_kernel for |x| <= 1
+		 *
+		 * 	For |x| > 1/2, asin(|x|) = pi/2 - 2*asin(sqrt((1 - |x|)/2)).
+		 */
+		template <typename T>
+		inline pack<T> reduce_asin(pack<T> x, pack<T>& z) {
+			using P = pack<T>;
+			P const half{static_cast<T>(0.5)};
+			auto const large = ::abs(x) > half;
+			z = x * x;
+			z.blend(::fnma(half, ::abs(x), half), large);
+			P t = x;
+			t.blend(sqrt(z), large);
+			return t;
+		}
+
+		/**
+		 * 	atan(t) for |t| <= trig_limits::atan_mid, given z = t*t
+		 */
+		inline pack<float> atan_kernel(pack<float> t, pack<float> z) {
+			static const float c[] = {8.05374449538e-2f, -1.38776856032E-1f, 1.99777106478E-1f, -3.33329491539E-1f};
+			return ::fma(horner(z, c) * z, t, t);
+		}
+		inline pack<double> atan_kernel(pack<double> t, pack<double> z) {
+			// From Cephes' atan.c
+			static const double p[] = {
+				-8.750608600031904122785E-1, -1.615753718733365076637E1, -7.500855792314704667340E1,
+				-1.228866684490136173410E2, -6.485021904942025371773E1
+			};
+			static const double q[] = {
+				1.0, 2.485846490142306297962E1, 1.650270098316988542046E2,
+				4.328810604912902668951E2, 4.853903996359136964868E2, 1.945506571482613964425E2
+			};
+			return ::fma(z * horner(z, p) / horner(z, q), t, t);
+		}
+	}
+}}
+
+namespace {
+	/**
+	 * \brief e^x
+	 */
+	template <typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	exp(scimd::pack<T> x) {
+		using P = scimd::pack<T>;
+		using L = scimd::detail::exp_limits<T>;
+		P n;
+		P const r = scimd::detail::reduce_ln2(x, n);
+		P result = scimd::detail::ldexp(scimd::detail::expm1_kernel(r) + P{static_cast<T>(1.0)}, n);
+		result.blend(P{std::numeric_limits<T>::infinity()}, x > P{L::max_log});
+		result.blend(P{static_cast<T>(0.0)}, x < P{L::min_log});
+		return result;
+	}
+
+	/**
+	 * \brief e^x - 1, accurate for small x
+	 */
+	template <typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	expm1(scimd::pack<T> x) {
+		using P = scimd::pack<T>;
+		using L = scimd::detail::exp_limits<T>;
+		P const one{static_cast<T>(1.0)};
+		P n;
+		P const r = scimd::detail::reduce_ln2(x, n);
+		P const em1 = scimd::detail::expm1_kernel(r);
+
+		// 2^n * (em1 + 1) - 1 without cancellation. 2^n overflows for the
+		// largest n, so that case is scaled by 2 afterwards.
+		P const max_exp{L::max_exp};
+		P const s = scimd::detail::ldexp(one, min(n, max_exp));
+		P result = ::fma(s, em1, s - one);
+		result.blend(result + result, n > max_exp);
+		result.blend(P{std::numeric_limits<T>::infinity()}, x > P{L::max_log});
+		result.blend(-one, x < P{L::min_log});
+		return result;
+	}
+
+	/**
+	 * \brief 2^x
+	 */
+	template <typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	exp2(scimd::pack<T> x) {
+		using P = scimd::pack<T>;
+		using L = scimd::detail::exp_limits<T>;
+		P const n = scimd::detail::round(x);
+		P const r = (x - n) * P{static_cast<T>(0.693147180559945309417)};
+		P result = scimd::detail::ldexp(scimd::detail::expm1_kernel(r) + P{static_cast<T>(1.0)}, n);
+		result.blend(P{std::numeric_limits<T>::infinity()}, x >= P{L::max_exp2});
+		result.blend(P{static_cast<T>(0.0)}, x < P{L::min_exp2});
+		return result;
+	}
+
+	/**
+	 * \brief Natural logarithm
+	 */
+	template <typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	log(scimd::pack<T> x) {
+		using P = scimd::pack<T>;
+		using L = scimd::detail::exp_limits<T>;
+		P e;
+		P const f = scimd::detail::reduce_log(x, e);
+		P const y = ::fma(e, P{L::ln2_lo}, scimd::detail::log1p_kernel(f));
+		P const result = ::fma(e, P{L::ln2_hi}, f + y);
+		return scimd::detail::log_special(result, x);
+	}
+
+	/**
+	 * \brief log(1 + x), accurate for small x
+	 */
+	template <typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	log1p(scimd::pack<T> x) {
+		using P = scimd::pack<T>;
+		P const one{static_cast<T>(1.0)};
+		P const u = x + one;
+		// Correct for the rounding of 1 + x: log(u + d) ~= log(u) + d/u
+		P const log_u = log(u);
+		P result = log_u + (x - (u - one)) / u;
+		result.blend(log_u, u > P{std::numeric_limits<T>::max()});
+		result.blend(P{-std::numeric_limits<T>::infinity()}, u <= P{static_cast<T>(0.0)});
+		return result;
+	}
+
+	/**
+	 * \brief Base-2 logarithm
+	 *
+	 * This is exact for integral powers of two.
+	 */
+	template <typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	log2(scimd::pack<T> x) {
+		scimd::pack<T> lo;
+		scimd::pack<T> const hi = scimd::detail::log2_hilo(x, lo);
+		return scimd::detail::log_special(hi + lo, x);
+	}
+
+	/**
+	 * \brief x^y
+	 *
+	 * Computed as 2^(y*log2(x)) with log2(x) carried in extended precision.
+	 */
+	template <typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	pow(scimd::pack<T> x, scimd::pack<T> y) {
+		using P = scimd::pack<T>;
+		using L = scimd::detail::exp_limits<T>;
+		P const zero{static_cast<T>(0.0)}, one{static_cast<T>(1.0)};
+		P const ax = abs(x);
+
+		P lo;
+		P hi = scimd::detail::log2_hilo(ax, lo);
+		hi = scimd::detail::log_special(hi, ax);
+
+		// y * log2(x) = p + p_err
+		P const p = y * hi;
+		P const p_err = scimd::detail::two_prod_err(y, hi, p) + y * lo;
+
+		P const n = scimd::detail::round(p);
+		P const r = ((p - n) + p_err) * P{static_cast<T>(0.693147180559945309417)};
+		P result = scimd::detail::ldexp(scimd::detail::expm1_kernel(r) + one, n);
+		result.blend(P{std::numeric_limits<T>::infinity()}, p >= P{L::max_exp2});
+		result.blend(zero, p < P{L::min_exp2});
+
+		// Negative bases are only defined for integral y. The result is
+		// negative if y is odd.
+		P const half_y = y * P{static_cast<T>(0.5)};
+		auto const is_frac = abs(scimd::detail::round(y) - y) > zero;
+		auto const is_odd = abs(scimd::detail::round(half_y) - half_y) > zero;
+		P negative = result;
+		negative.blend(-result, is_odd);
+		P undefined{std::numeric_limits<T>::quiet_NaN()};
+		undefined.blend(result, ax > P{std::numeric_limits<T>::max()});
+		negative.blend(undefined, is_frac);
+		result.blend(negative, x < zero);
+
+		// (-1)^+-inf = 1
+		P unit = result;
+		unit.blend(one, abs(y) > P{std::numeric_limits<T>::max()});
+		result.blend(unit, abs(ax - one) <= zero);
+
+		// x^0 = 1 and 1^y = 1, even for NaN
+		result.blend(one, abs(y) <= zero);
+		result.blend(one, abs(x - one) <= zero);
+		return result;
+	}
+	template <typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	pow(scimd::pack<T> x, T y) { return pow(x, scimd::pack<T>{y}); }
+
+	/**
+	 * \brief Sine
+	 *
+	 * Pass scimd::range::limited{} as the second argument if |x| is known
+	 * to be small (see scimd::range).
+	 */
+	template <typename T, typename Range>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	sin(scimd::pack<T> x, Range range) {
+		scimd::pack<T> q;
+		scimd::pack<T> const r = scimd::detail::reduce_quadrant(x, q, range);
+		return scimd::detail::sin_quadrant(q, scimd::detail::sin_kernel(r), scimd::detail::cos_kernel(r));
+	}
+	template <typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	sin(scimd::pack<T> x) { return sin(x, scimd::range::full{}); }
+
+	/**
+	 * \brief Cosine
+	 */
+	template <typename T, typename Range>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	cos(scimd::pack<T> x, Range range) {
+		scimd::pack<T> q;
+		scimd::pack<T> const r = scimd::detail::reduce_quadrant(x, q, range);
+		// cos(x) = sin(x + pi/2)
+		return scimd::detail::sin_quadrant(q, scimd::detail::cos_kernel(r), -scimd::detail::sin_kernel(r));
+	}
+	template <typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	cos(scimd::pack<T> x) { return cos(x, scimd::range::full{}); }
+
+	/**
+	 * \brief Sine and cosine with a single argument reduction
+	 */
+	template <typename T, typename Range>
+	inline typename std::enable_if<std::is_floating_point<T>::value>::type
+	sincos(scimd::pack<T> x, scimd::pack<T>& s, scimd::pack<T>& c, Range range) {
+		scimd::pack<T> q;
+		scimd::pack<T> const r = scimd::detail::reduce_quadrant(x, q, range);
+		scimd::pack<T> const sr = scimd::detail::sin_kernel(r), cr = scimd::detail::cos_kernel(r);
+		s = scimd::detail::sin_quadrant(q, sr, cr);
+		c = scimd::detail::sin_quadrant(q, cr, -sr);
+	}
+	template <typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value>::type
+	sincos(scimd::pack<T> x, scimd::pack<T>& s, scimd::pack<T>& c) { sincos(x, s, c, scimd::range::full{}); }
+
+	/**
+	 * \brief Tangent
+	 */
+	template <typename T, typename Range>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	tan(scimd::pack<T> x, Range range) {
+		using P = scimd::pack<T>;
+		P q;
+		P const r = scimd::detail::reduce_quadrant(x, q, range);
+		P const t = scimd::detail::tan_kernel(r);
+
+		// tan(r + pi/2) = -1/tan(r)
+		P const cot = P{static_cast<T>(-1.0)} / t;
+		P result = t;
+		result.blend(cot, q > P{static_cast<T>(0.5)});
+		result.blend(t, q > P{static_cast<T>(1.5)});
+		result.blend(cot, q > P{static_cast<T>(2.5)});
+		return result;
+	}
+	template <typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	tan(scimd::pack<T> x) { return tan(x, scimd::range::full{}); }
+
+	/**
+	 * \brief Arc sine
+	 */
+	template <typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	asin(scimd::pack<T> x) {
+		using P = scimd::pack<T>;
+		using L = scimd::detail::trig_limits<T>;
+		P z;
+		P const t = scimd::detail::reduce_asin(x, z);
+		P const k = scimd::detail::asin_kernel(t, z);
+
+		// t is positive for |x| > 1/2, so the sign of x is restored
+		P large = P{L::pio2_hi} - ::fms(P{static_cast<T>(2.0)}, k, P{L::pio2_lo});
+		large.blend(-large, x < P{static_cast<T>(0.0)});
+		P result = k;
+		result.blend(large, abs(x) > P{static_cast<T>(0.5)});
+		return result;
+	}
+
+	/**
+	 * \brief Arc cosine
+	 */
+	template <typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	acos(scimd::pack<T> x) {
+		using P = scimd::pack<T>;
+		using L = scimd::detail::trig_limits<T>;
+		P const half{static_cast<T>(0.5)};
+		P z;
+		P const t = scimd::detail::reduce_asin(x, z);
+		P const k = scimd::detail::asin_kernel(t, z);
+
+		// pi/2 - asin(x) for |x| <= 1/2, 2*asin(t) for x > 1/2,
+		// and pi - 2*asin(t) for x < -1/2
+		P const m = P{L::pio2_hi} - (k - P{L::pio2_lo});
+		P result = m;
+		result.blend(k + k, x > half);
+		result.blend(m + m, x < -half);
+		return result;
+	}
+
+	/**
+	 * \brief Arc tangent
+	 */
+	template <typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	atan(scimd::pack<T> x) {
+		using P = scimd::pack<T>;
+		using L = scimd::detail::trig_limits<T>;
+		P const zero{static_cast<T>(0.0)}, one{static_cast<T>(1.0)};
+		P const ax = abs(x);
+		auto const mid = ax > P{L::atan_mid};
+		auto const high = ax > P{L::atan_high};
+
+		// atan(x) = pi/4 + atan((x - 1)/(x + 1)) = pi/2 + atan(-1/x)
+		P num = x, den = one, base = zero, base_lo = zero;
+		num.blend(ax - one, mid);
+		den.blend(ax + one, mid);
+		base.blend(P{L::pio2_hi * static_cast<T>(0.5)}, mid);
+		base_lo.blend(P{L::pio2_lo * static_cast<T>(0.5)}, mid);
+		num.blend(-one, high);
+		den.blend(ax, high);
+		base.blend(P{L::pio2_hi}, high);
+		base_lo.blend(P{L::pio2_lo}, high);
+
+		P const t = num / den;
+		P result = base + (scimd::detail::atan_kernel(t, t * t) + base_lo);
+
+		// Small arguments kept their sign
+		result.blend(-result, x < -P{L::atan_mid});
+		return result;
+	}
+
+	/**
+	 * \brief Arc tangent of y/x using the signs of both to find the quadrant
+	 *
+	 * The result is in [-pi, pi].
+	 */
+	template <typename T>
+	inline typename std::enable_if<std::is_floating_point<T>::value, scimd::pack<T>>::type
+	atan2(scimd::pack<T> y, scimd::pack<T> x) {
+		using P = scimd::pack<T>;
+		using L = scimd::detail::trig_limits<T>;
+		P const zero{static_cast<T>(0.0)}, inf{std::numeric_limits<T>::infinity()};
+		P const pio4{L::pio2_hi * static_cast<T>(0.5)}, pio4_lo{L::pio2_lo * static_cast<T>(0.5)};
+		// abs keeps the sign of -0, which would flip the sign of y/0
+		P const ax = abs(x) + zero, ay = abs(y);
+
+		// Solve in the first quadrant, where 0/0 and inf/inf need fixing up
+		P result = atan(ay / ax);
+		result.blend(zero, ay <= zero);
+		P both_inf = result;
+		both_inf.blend(pio4 + pio4_lo, ay >= inf);
+		result.blend(both_inf, ax >= inf);
+
+		// Propagate NaN inputs
+		P nan = ax + ay;
+		nan.blend(result, nan >= zero);
+		result = nan;
+
+		// pi - result in the left half-plane
+		P const pi{L::pio2_hi * static_cast<T>(2.0)}, pi_lo{L::pio2_lo * static_cast<T>(2.0)};
+		result.blend(pi - (result - pi_lo), x < zero);
+		result.blend(-result, y < zero);
+		return result;
+	}
+}
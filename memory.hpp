@@ -1,8 +1,19 @@
 #pragma once
 
 #include <malloc.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <limits>
 #include <new>
 #include <stdexcept>
+#include <type_traits>
+#ifdef __SSE__
+#include <xmmintrin.h>
+#endif
 
 namespace scimd {
 	namespace memory {
@@ -36,6 +47,30 @@ namespace scimd {
 		struct compact{};
 		struct ragged{};
 
+		/**
+		 * \brief Non-temporal store
+		 *
+		 * An aligned store that bypasses the caches. The destination is not
+		 * read for ownership and the working set is not evicted, so this is
+		 * faster for large outputs that are not read again soon. It is much
+		 * slower for data that is read back while still in cache.
+		 *
+		 * Streaming stores are weakly ordered. Call sfence() after the last
+		 * one before another thread reads the data or a flag says it is ready.
+		 */
+		struct streaming{};
+
+		/**
+		 * \brief Order all preceding streaming stores before later stores
+		 */
+		inline void sfence() noexcept {
+#ifdef __SSE__
+			_mm_sfence();
+#else
+			std::atomic_thread_fence(std::memory_order_seq_cst);
+#endif
+		}
+
 		/**
 		 * \brief Check if alignments are convertible
 		 *
@@ -49,43 +84,267 @@ namespace scimd {
 					!(std::is_same<target, aligned>::value &&
 					  std::is_same<source, unaligned>::value);
 		};
-	}
 
-	template<typename T, size_t Align = 16>
-	class allocator {
-	public:
-		using value_type = T;
+		/**
+		 * \brief Size in bytes of the data cache at `level` (1, 2, or 3)
+		 *
+		 * This is what the C library reports for the current CPU. When it
+		 * does not know (e.g., in some containers), a typical size is used
+		 * instead: 32 KiB, 256 KiB, and 8 MiB, respectively.
+		 */
+		inline size_t cache_size(int level) {
+			long bytes = 0;
+			size_t fallback = 0;
+			switch (level) {
+				case 1: bytes = sysconf(_SC_LEVEL1_DCACHE_SIZE); fallback = size_t{32} << 10; break;
+				case 2: bytes = sysconf(_SC_LEVEL2_CACHE_SIZE);  fallback = size_t{256} << 10; break;
+				case 3: bytes = sysconf(_SC_LEVEL3_CACHE_SIZE);  fallback = size_t{8} << 20; break;
+				default: throw std::invalid_argument { "Cache level must be 1, 2, or 3" };
+			}
+			return (bytes > 0) ? static_cast<size_t>(bytes) : fallback;
+		}
+
+		/**
+		 * \brief Page policies for scimd::allocator
+		 *
+		 * standard_pages: aligned_alloc, so the memory is on the usual 4 KiB
+		 * 				   pages.
+		 *
+		 * huge_pages: Allocations of at least 2 MiB are mapped directly and
+		 * 			   rounded up to 2 MiB pages, so a strided or random walk
+		 * 			   over them misses the TLB 512 times less often. Explicit
+		 * 			   huge pages (MAP_HUGETLB) are used if the system has
+		 * 			   reserved some; otherwise, the mapping is aligned to
+		 * 			   2 MiB and marked for transparent huge pages
+		 * 			   (MADV_HUGEPAGE). Either may silently yield 4 KiB pages,
+		 * 			   so use huge_page_bytes() to check what was obtained.
+		 * 			   Smaller allocations use standard_pages.
+		 *
+		 * \note The alignment must not exceed 2 MiB.
+		 */
+		struct standard_pages {
+			static void* allocate(size_t align, size_t bytes) noexcept {
+				return aligned_alloc(align, bytes);
+			}
+			static void deallocate(void* p, size_t) noexcept {
+				free(p);
+			}
+		};
+
+		struct huge_pages {
+			static constexpr size_t page_size = size_t{2} << 20;
 
-		allocator() noexcept = default;
-		allocator(const allocator&) noexcept = default;
-		~allocator() noexcept = default;
+			static void* allocate(size_t align, size_t bytes) noexcept {
+				if (bytes < page_size) {
+					return standard_pages::allocate(align, bytes);
+				}
+				size_t const size = round_up(bytes);
+				void* p = mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+				if (p != MAP_FAILED) {
+					return p;
+				}
 
-		template<typename U>
-		struct rebind {
-			using other = allocator;
+				// Over-allocate by a page so that an aligned range fits, then trim
+				p = mmap(nullptr, size + page_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if (p == MAP_FAILED) {
+					return nullptr;
+				}
+				char* const first = static_cast<char*>(p);
+				char* const aligned = first + (page_size - reinterpret_cast<uintptr_t>(first) % page_size) % page_size;
+				if (aligned != first) {
+					munmap(first, static_cast<size_t>(aligned - first));
+				}
+				size_t const tail = page_size - static_cast<size_t>(aligned - first);
+				if (tail != 0) {
+					munmap(aligned + size, tail);
+				}
+#ifdef MADV_HUGEPAGE
+				madvise(aligned, size, MADV_HUGEPAGE);
+#endif
+				return aligned;
+			}
+			static void deallocate(void* p, size_t bytes) noexcept {
+				if (bytes < page_size) {
+					standard_pages::deallocate(p, bytes);
+				} else {
+					munmap(p, round_up(bytes));
+				}
+			}
+
+		private:
+			static size_t round_up(size_t bytes) noexcept { return (bytes + page_size - 1) / page_size * page_size; }
 		};
 
-		T* allocate(size_t n) {
-			T *data = static_cast<T*>(aligned_alloc(Align, n * sizeof(T)));
-			if (!data) {
-				throw std::runtime_error { "Bad allocation" };
+		/**
+		 * \brief The number of bytes of the mapping containing `p` that are on huge pages
+		 *
+		 * This reads /proc/self/smaps, so it is slow; it is meant for checking
+		 * an allocation once. It returns zero when the mapping is not found
+		 * or smaps is not available.
+		 */
+		inline size_t huge_page_bytes(void const* p) {
+			FILE* smaps = fopen("/proc/self/smaps", "r");
+			if (!smaps) {
+				return 0;
+			}
+			uintptr_t const address = reinterpret_cast<uintptr_t>(p);
+			bool found = false;
+			size_t size = 0, anon_huge = 0, page = 0;
+			char line[256];
+			while (fgets(line, sizeof(line), smaps)) {
+				unsigned long long begin, end, kb;
+				// Each mapping starts with its range, e.g., "7f0000000000-7f0000200000 rw-p ..."
+				if (sscanf(line, "%llx-%llx ", &begin, &end) == 2) {
+					if (found) {
+						break;
+					}
+					found = (address >= begin && address < end);
+				} else if (found) {
+					if (sscanf(line, "Size: %llu kB", &kb) == 1) {
+						size = static_cast<size_t>(kb) << 10;
+					} else if (sscanf(line, "AnonHugePages: %llu kB", &kb) == 1) {
+						anon_huge = static_cast<size_t>(kb) << 10;
+					} else if (sscanf(line, "KernelPageSize: %llu kB", &kb) == 1) {
+						page = static_cast<size_t>(kb) << 10;
+					}
+				}
+			}
+			fclose(smaps);
+			if (!found) {
+				return 0;
 			}
-			return data;
+			// MAP_HUGETLB mappings are entirely on huge pages
+			return (page >= huge_pages::page_size) ? size : anon_huge;
 		}
+	}
 
-		void deallocate(T *p, size_t) {
-			if (p) {
-				free(p);
+	/**
+	 * \brief Fetch the cache line holding `p` into cache level `Level` (1, 2, or 3)
+	 *
+	 * This is only a hint; it never faults, so `p` may be invalid.
+	 */
+	template <int Level = 1>
+	inline void prefetch(void const* p) noexcept {
+		static_assert(Level >= 1 && Level <= 3, "Prefetch level must be 1, 2, or 3");
+#ifdef __SSE__
+		_mm_prefetch(static_cast<char const*>(p), (Level == 1) ? _MM_HINT_T0 : (Level == 2) ? _MM_HINT_T1 : _MM_HINT_T2);
+#else
+		__builtin_prefetch(p, 0, 4 - Level);
+#endif
+	}
+
+	/**
+	 * \brief Fetch the cache line holding `p`, minimizing cache pollution
+	 *
+	 * For data that is read once.
+	 */
+	inline void prefetch_nta(void const* p) noexcept {
+#ifdef __SSE__
+		_mm_prefetch(static_cast<char const*>(p), _MM_HINT_NTA);
+#else
+		__builtin_prefetch(p, 0, 0);
+#endif
+	}
+
+	/**
+	 * \brief Fetch the cache line holding `p` into L1 in anticipation of a write
+	 *
+	 * This is prefetchw when the target supports it (e.g., -mprfchw or
+	 * -march=broadwell and later) and a read prefetch otherwise.
+	 */
+	inline void prefetch_write(void* p) noexcept {
+		__builtin_prefetch(p, 1, 3);
+	}
+
+	/*
+	 * 	The allocator's default alignment depends on the instruction set,
+	 * 	so it lives in the instruction set's namespace (see scimd.hpp).
+	 */
+	inline namespace SCIMD_ISA_NAMESPACE {
+		/**
+		 * \brief The alignment in bytes of a pack of T's (at least alignof(T))
+		 *
+		 * Defined in scimd.hpp, once the packs are.
+		 */
+		template <typename T>
+		struct pack_alignment;
+
+		/**
+		 * \brief An allocator for SIMD loads and stores
+		 *
+		 * By default, the memory is aligned for pack<T>, so it can always be
+		 * loaded with memory::aligned. Each allocation is also rounded up to
+		 * a multiple of the alignment (and the pack size), so the last pack
+		 * can be loaded and stored whole. The padding is uninitialized.
+		 *
+		 * The allocator is stateless and all instances with the same page
+		 * policy (see memory::huge_pages) compare equal, so containers move
+		 * and swap their buffers without copying elements.
+		 */
+		template<typename T, size_t Align = pack_alignment<T>::value, typename Pages = memory::standard_pages>
+		class allocator {
+			static_assert(Align != 0 && (Align & (Align - 1)) == 0, "Alignment must be a power of two");
+
+		public:
+			using value_type = T;
+			using page_policy = Pages;
+			using propagate_on_container_copy_assignment = std::true_type;
+			using propagate_on_container_move_assignment = std::true_type;
+			using propagate_on_container_swap = std::true_type;
+			using is_always_equal = std::true_type;
+
+			static constexpr size_t alignment = Align;
+
+			allocator() noexcept = default;
+			allocator(const allocator&) noexcept = default;
+			template<typename U>
+			allocator(const allocator<U, Align, Pages>&) noexcept {}
+			~allocator() noexcept = default;
+
+			// e.g., for the nodes of a std::list
+			template<typename U>
+			struct rebind {
+				using other = allocator<U, Align, Pages>;
+			};
+
+			T* allocate(size_t n) {
+				if (n > (std::numeric_limits<size_t>::max() - padding) / sizeof(T)) {
+					throw std::runtime_error { "Bad allocation" };
+				}
+				T *data = static_cast<T*>(Pages::allocate(align, bytes(n)));
+				if (!data && n != 0) {
+					throw std::runtime_error { "Bad allocation" };
+				}
+				return data;
 			}
-		}
-	};
-}
 
-template<class T, class U>
-bool operator==(const scimd::allocator<T>&, const scimd::allocator<U>&) noexcept {
-	return false;
-}
-template<class T, class U>
-bool operator !=(const scimd::allocator<T>&a, const scimd::allocator<U>&b) noexcept {
-	return !(a == b);
+			void deallocate(T *p, size_t n) {
+				if (p) {
+					Pages::deallocate(p, bytes(n));
+				}
+			}
+
+		private:
+			static constexpr size_t align = (Align > alignof(T)) ? Align : alignof(T);
+			static constexpr size_t padding = (align > pack_alignment<T>::value) ? align : pack_alignment<T>::value;
+
+			static size_t bytes(size_t n) noexcept { return (n * sizeof(T) + padding - 1) / padding * padding; }
+		};
+		template <typename T, size_t Align, typename Pages>
+		constexpr size_t allocator<T, Align, Pages>::alignment;
+
+		// Memory from any of them can be freed by any other with the same page policy
+		template<class T, size_t A, class U, size_t B, class Pages>
+		bool operator==(const allocator<T, A, Pages>&, const allocator<U, B, Pages>&) noexcept {
+			return true;
+		}
+		template<class T, size_t A, class U, size_t B, class P, class Q>
+		bool operator==(const allocator<T, A, P>&, const allocator<U, B, Q>&) noexcept {
+			return false;
+		}
+		template<class T, size_t A, class U, size_t B, class P, class Q>
+		bool operator!=(const allocator<T, A, P>& a, const allocator<U, B, Q>& b) noexcept {
+			return !(a == b);
+		}
+	}
 }
@@ -0,0 +1,344 @@
+#pragma once
+
+#include "scimd.hpp"
+#include <array>
+#include <cstddef>
+
+/**
+ * 	Multi-register packs
+ *
+ * 	A multipack<T, N> is N independent pack<T> registers that are used as
+ * 	one vector of N * pack<T>::size lanes. Every operation is issued once per
+ * 	register, and the registers do not depend on each other. A chain of
+ * 	dependent operations (e.g., an accumulation or a Newton iteration) then
+ * 	keeps N operations in flight instead of waiting on the latency of each
+ * 	one. The cost is N times the register pressure, so N should stay small
+ * 	enough that the compiler does not spill (16 registers on SSE and AVX,
+ * 	32 on AVX-512).
+ *
+ * 	The lanes are ordered register by register: lane `k` is lane
+ * 	`k % pack<T>::size` of register `k / pack<T>::size`.
+ */
+namespace scimd { inline namespace SCIMD_ISA_NAMESPACE {
+
+	template <typename T, size_t N>
+	struct multipack {
+		static_assert(N > 0, "A multipack needs at least one register");
+
+		using value_type = T;
+		using pack_type = pack<T>;
+		using category = typename pack_type::category;
+		static constexpr size_t registers = N;
+		static constexpr size_t size = N * pack_type::size;
+
+		/*
+		 * 	One mask per register. This is a struct rather than a std::array
+		 * 	because the attributes on the intrinsic types would be dropped
+		 * 	from a template argument.
+		 */
+		struct bool_t {
+			typename pack_type::bool_t val[N];
+			typename pack_type::bool_t& operator[](size_t i) { return val[i]; }
+			typename pack_type::bool_t const& operator[](size_t i) const { return val[i]; }
+		};
+
+		std::array<pack_type, N> val;
+
+		explicit multipack() {}
+		multipack(pack_type x) { val.fill(x); }
+		multipack(T x) { val.fill(pack_type{x}); }
+
+		multipack operator -() const {
+			multipack r;
+			for (size_t i = 0; i < N; i++) { r.val[i] = -val[i]; }
+			return r;
+		}
+		multipack operator +(multipack x) const { return apply(x, [](pack_type a, pack_type b) { return a + b; }); }
+		multipack operator -(multipack x) const { return apply(x, [](pack_type a, pack_type b) { return a - b; }); }
+		multipack operator *(multipack x) const { return apply(x, [](pack_type a, pack_type b) { return a * b; }); }
+		multipack operator /(multipack x) const { return apply(x, [](pack_type a, pack_type b) { return a / b; }); }
+
+		multipack operator +=(multipack x) { return *this = *this + x; }
+		multipack operator -=(multipack x) { return *this = *this - x; }
+		multipack operator *=(multipack x) { return *this = *this * x; }
+		multipack operator /=(multipack x) { return *this = *this / x; }
+
+		conditional_t<multipack> operator < (multipack x) const { return compare(x, [](pack_type a, pack_type b) { return a <  b; }); }
+		conditional_t<multipack> operator > (multipack x) const { return compare(x, [](pack_type a, pack_type b) { return a >  b; }); }
+		conditional_t<multipack> operator <=(multipack x) const { return compare(x, [](pack_type a, pack_type b) { return a <= b; }); }
+		conditional_t<multipack> operator >=(multipack x) const { return compare(x, [](pack_type a, pack_type b) { return a >= b; }); }
+
+		multipack blend(multipack x, conditional_t<multipack> mask) {
+			for (size_t i = 0; i < N; i++) {
+				val[i].blend(x.val[i], conditional_t<pack_type>{mask.val[i]});
+			}
+			return *this;
+		}
+
+		/**
+		 * \brief The multipack of `f(val[i], x.val[i])` for each register
+		 */
+		template <typename BinaryFunc>
+		multipack apply(multipack x, BinaryFunc f) const {
+			multipack r;
+			for (size_t i = 0; i < N; i++) { r.val[i] = f(val[i], x.val[i]); }
+			return r;
+		}
+
+		/* ----------------------------------------------------------
+		 * 			Load/Store methods
+		 *
+		 * 	These are the same as for pack<T>. The registers are
+		 * 	consecutive in memory, so an aligned load only requires
+		 * 	the alignment of a single pack<T>.
+		 *---------------------------------------------------------*/
+		value_type const* load(                   value_type const* p) { return this->load(memory::unaligned{}, p); }
+		value_type const* load(memory::unaligned, value_type const* p) {
+			for (auto& v : val) { p = v.load(memory::unaligned{}, p); }
+			return p;
+		}
+		value_type const* load(memory::aligned,   value_type const* p) {
+			for (auto& v : val) { p = v.load(memory::aligned{}, p); }
+			return p;
+		}
+
+		/**
+		 * \brief Load the first `n` elements of a multipack from memory
+		 *
+		 * Lanes at or beyond `n` are set to zero, and memory past `p + n`
+		 * is never touched.
+		 *
+		 * \pre n <= size
+		 */
+		value_type const* load_n(value_type const* p, size_t n) {
+			for (auto& v : val) {
+				size_t const m = std::min(n, pack_type::size);
+				if (m == pack_type::size) {
+					v.load(memory::unaligned{}, p);
+				} else {
+					v.load_n(p, m);
+				}
+				p += m;
+				n -= m;
+			}
+			return p;
+		}
+
+		value_type* store(                   value_type* p) { return this->store(memory::unaligned{}, p); }
+		value_type* store(memory::unaligned, value_type* p) {
+			for (auto& v : val) { p = v.store(memory::unaligned{}, p); }
+			return p;
+		}
+		value_type* store(memory::aligned,   value_type* p) {
+			for (auto& v : val) { p = v.store(memory::aligned{}, p); }
+			return p;
+		}
+		value_type* store(memory::streaming, value_type* p) {
+			for (auto& v : val) { p = v.store(memory::streaming{}, p); }
+			return p;
+		}
+
+		/**
+		 * \brief Store the first `n` elements of a multipack to memory
+		 *
+		 * \pre n <= size
+		 */
+		value_type* store_n(value_type* p, size_t n) {
+			for (auto& v : val) {
+				size_t const m = std::min(n, pack_type::size);
+				if (m == pack_type::size) {
+					v.store(memory::unaligned{}, p);
+				} else if (m > 0) {
+					v.store_n(p, m);
+				}
+				p += m;
+				n -= m;
+			}
+			return p;
+		}
+
+	private:
+		template <typename BinaryFunc>
+		conditional_t<multipack> compare(multipack x, BinaryFunc f) const {
+			bool_t mask;
+			for (size_t i = 0; i < N; i++) { mask[i] = f(val[i], x.val[i]).val; }
+			return mask;
+		}
+	};
+
+	namespace detail {
+		/*
+		 * 	Combine the registers pairwise, so the dependency chain
+		 * 	is log2(N) long instead of N.
+		 */
+		template <typename T, size_t N, typename BinaryFunc>
+		pack<T> fold(multipack<T, N> const& x, BinaryFunc f) {
+			auto v = x.val;
+			for (size_t width = N; width > 1; width = (width + 1) / 2) {
+				size_t const half = width / 2;
+				for (size_t i = 0; i < half; i++) {
+					v[i] = f(v[i], v[width - half + i]);
+				}
+			}
+			return v[0];
+		}
+	}
+}}
+
+/* ----------------------------------------------------------
+ * 			scalar+multipack Operators
+ *---------------------------------------------------------*/
+template <typename T, size_t N>
+scimd::multipack<T, N> operator +(typename scimd::multipack<T, N>::value_type x, scimd::multipack<T, N> b) { return scimd::multipack<T, N>(x) + b; }
+template <typename T, size_t N>
+scimd::multipack<T, N> operator -(typename scimd::multipack<T, N>::value_type x, scimd::multipack<T, N> b) { return scimd::multipack<T, N>(x) - b; }
+template <typename T, size_t N>
+scimd::multipack<T, N> operator *(typename scimd::multipack<T, N>::value_type x, scimd::multipack<T, N> b) { return scimd::multipack<T, N>(x) * b; }
+template <typename T, size_t N>
+scimd::multipack<T, N> operator /(typename scimd::multipack<T, N>::value_type x, scimd::multipack<T, N> b) { return scimd::multipack<T, N>(x) / b; }
+
+template <typename T, size_t N>
+scimd::conditional_t<scimd::multipack<T, N>> operator < (typename scimd::multipack<T, N>::value_type x, scimd::multipack<T, N> y) { return scimd::multipack<T, N>{x}  < y; }
+template <typename T, size_t N>
+scimd::conditional_t<scimd::multipack<T, N>> operator > (typename scimd::multipack<T, N>::value_type x, scimd::multipack<T, N> y) { return scimd::multipack<T, N>{x}  > y; }
+template <typename T, size_t N>
+scimd::conditional_t<scimd::multipack<T, N>> operator <=(typename scimd::multipack<T, N>::value_type x, scimd::multipack<T, N> y) { return scimd::multipack<T, N>{x} <= y; }
+template <typename T, size_t N>
+scimd::conditional_t<scimd::multipack<T, N>> operator >=(typename scimd::multipack<T, N>::value_type x, scimd::multipack<T, N> y) { return scimd::multipack<T, N>{x} >= y; }
+
+/* ----------------------------------------------------------
+ * 			Logical Functions
+ *---------------------------------------------------------*/
+template <typename T, size_t N>
+inline bool all(scimd::conditional_t<scimd::multipack<T, N>> x) {
+	for (size_t i = 0; i < N; i++) {
+		if (!all(scimd::conditional_t<scimd::pack<T>>{x.val[i]})) { return false; }
+	}
+	return true;
+}
+template <typename T, size_t N>
+inline bool none(scimd::conditional_t<scimd::multipack<T, N>> x) {
+	for (size_t i = 0; i < N; i++) {
+		if (!none(scimd::conditional_t<scimd::pack<T>>{x.val[i]})) { return false; }
+	}
+	return true;
+}
+template <typename T, size_t N>
+inline bool any(scimd::conditional_t<scimd::multipack<T, N>> x) { return !none(x); }
+
+/* ----------------------------------------------------------
+ * 			Range and Fused Multiply-Add Functions
+ *---------------------------------------------------------*/
+template <typename T, size_t N>
+inline scimd::multipack<T, N> max(scimd::multipack<T, N> x, scimd::multipack<T, N> b) {
+	return x.apply(b, [](scimd::pack<T> l, scimd::pack<T> r) { return max(l, r); });
+}
+template <typename T, size_t N>
+inline scimd::multipack<T, N> min(scimd::multipack<T, N> x, scimd::multipack<T, N> b) {
+	return x.apply(b, [](scimd::pack<T> l, scimd::pack<T> r) { return min(l, r); });
+}
+template <typename T, size_t N>
+inline scimd::multipack<T, N> abs(scimd::multipack<T, N> x) {
+	for (auto& v : x.val) { v = abs(v); }
+	return x;
+}
+
+template <typename T, size_t N>
+inline scimd::multipack<T, N> fma(scimd::multipack<T, N> a, scimd::multipack<T, N> b, scimd::multipack<T, N> c) {
+	for (size_t i = 0; i < N; i++) { c.val[i] = fma(a.val[i], b.val[i], c.val[i]); }
+	return c;
+}
+template <typename T, size_t N>
+inline scimd::multipack<T, N> fms(scimd::multipack<T, N> a, scimd::multipack<T, N> b, scimd::multipack<T, N> c) {
+	for (size_t i = 0; i < N; i++) { c.val[i] = fms(a.val[i], b.val[i], c.val[i]); }
+	return c;
+}
+template <typename T, size_t N>
+inline scimd::multipack<T, N> fnma(scimd::multipack<T, N> a, scimd::multipack<T, N> b, scimd::multipack<T, N> c) {
+	for (size_t i = 0; i < N; i++) { c.val[i] = fnma(a.val[i], b.val[i], c.val[i]); }
+	return c;
+}
+template <typename T, size_t N>
+inline scimd::multipack<T, N> fnms(scimd::multipack<T, N> a, scimd::multipack<T, N> b, scimd::multipack<T, N> c) {
+	for (size_t i = 0; i < N; i++) { c.val[i] = fnms(a.val[i], b.val[i], c.val[i]); }
+	return c;
+}
+
+/* ----------------------------------------------------------
+ * 			Square Roots and Reciprocals
+ *
+ * 	As for pack<T>, sqrt returns a proxy: converting it gives the
+ * 	IEEE square root, and dividing by it uses div_sqrt at the
+ * 	requested precision.
+ *---------------------------------------------------------*/
+template <typename T, size_t N, typename Precision>
+struct sqrt_proxy<scimd::multipack<T, N>, Precision> {
+	scimd::multipack<T, N> value;
+	explicit sqrt_proxy(scimd::multipack<T, N> x) : value{x} {}
+	operator scimd::multipack<T, N>() {
+		scimd::multipack<T, N> r;
+		for (size_t i = 0; i < N; i++) { r.val[i] = scimd::pack<T>(sqrt_proxy<scimd::pack<T>>(value.val[i])); }
+		return r;
+	}
+};
+
+template <typename T, size_t N>
+inline sqrt_proxy<scimd::multipack<T, N>> sqrt(scimd::multipack<T, N> x) {
+	return sqrt_proxy<scimd::multipack<T, N>>(x);
+}
+template <typename T, size_t N, typename Precision>
+inline sqrt_proxy<scimd::multipack<T, N>, Precision> sqrt(scimd::multipack<T, N> x, Precision) {
+	return sqrt_proxy<scimd::multipack<T, N>, Precision>(x);
+}
+template <typename T, size_t N, typename Precision>
+inline scimd::multipack<T, N> operator/(scimd::multipack<T, N> lhs, sqrt_proxy<scimd::multipack<T, N>, Precision> rhs) {
+	return lhs.apply(rhs.value, [](scimd::pack<T> l, scimd::pack<T> r) { return l / sqrt_proxy<scimd::pack<T>, Precision>(r); });
+}
+template <typename T, size_t N, typename Precision>
+inline scimd::multipack<T, N> operator/(typename scimd::multipack<T, N>::value_type a, sqrt_proxy<scimd::multipack<T, N>, Precision> rhs) {
+	return scimd::multipack<T, N>(a) / rhs;
+}
+template <typename T, size_t N>
+inline scimd::multipack<T, N> rsqrt(scimd::multipack<T, N> x) {
+	for (auto& v : x.val) { v = ::rsqrt(v); }
+	return x;
+}
+template <typename T, size_t N, typename Precision>
+inline scimd::multipack<T, N> rsqrt(scimd::multipack<T, N> x, Precision) {
+	for (auto& v : x.val) { v = ::rsqrt(v, Precision{}); }
+	return x;
+}
+template <typename T, size_t N>
+inline scimd::multipack<T, N> rcp(scimd::multipack<T, N> x) {
+	for (auto& v : x.val) { v = ::rcp(v); }
+	return x;
+}
+template <typename T, size_t N, typename Precision>
+inline scimd::multipack<T, N> rcp(scimd::multipack<T, N> x, Precision) {
+	for (auto& v : x.val) { v = ::rcp(v, Precision{}); }
+	return x;
+}
+template <typename T, size_t N, typename Precision>
+inline scimd::multipack<T, N> div(scimd::multipack<T, N> x, scimd::multipack<T, N> y, Precision) {
+	return x.apply(y, [](scimd::pack<T> l, scimd::pack<T> r) { return div(l, r, Precision{}); });
+}
+
+/* ----------------------------------------------------------
+ * 			Horizontal Reductions
+ *---------------------------------------------------------*/
+template <typename T, size_t N>
+inline T reduce_add(scimd::multipack<T, N> const& x) {
+	return reduce_add(scimd::detail::fold(x, [](scimd::pack<T> l, scimd::pack<T> r) { return l + r; }));
+}
+template <typename T, size_t N>
+inline T reduce_mul(scimd::multipack<T, N> const& x) {
+	return reduce_mul(scimd::detail::fold(x, [](scimd::pack<T> l, scimd::pack<T> r) { return l * r; }));
+}
+template <typename T, size_t N>
+inline T reduce_min(scimd::multipack<T, N> const& x) {
+	return reduce_min(scimd::detail::fold(x, [](scimd::pack<T> l, scimd::pack<T> r) { return min(l, r); }));
+}
+template <typename T, size_t N>
+inline T reduce_max(scimd::multipack<T, N> const& x) {
+	return reduce_max(scimd::detail::fold(x, [](scimd::pack<T> l, scimd::pack<T> r) { return max(l, r); }));
+}
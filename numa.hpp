@@ -0,0 +1,227 @@
+#pragma once
+
+#include "scimd.hpp"
+#include "thread_pool.hpp"
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+/**
+ * 	NUMA-aware placement
+ *
+ * 	Linux places a page on the node of the CPU that first writes it. An
+ * 	array that one thread initializes therefore lives entirely on that
+ * 	thread's node, and a parallel loop over it is limited to the bandwidth
+ * 	of a single socket. partitioned_array instead has each thread of a pool
+ * 	first touch the partition it will later compute on.
+ *
+ * 	The topology is read from /sys/devices/system/node and the placement of
+ * 	pages is queried with the move_pages system call, so libnuma is not
+ * 	needed. On a machine (or kernel) without NUMA, everything is on node 0.
+ */
+namespace scimd {
+	namespace numa {
+		namespace detail {
+			// Parse a kernel CPU or node list, e.g., "0-3,8-11"
+			inline std::vector<size_t> parse_list(std::string const& list) {
+				std::vector<size_t> ids;
+				size_t i = 0;
+				while (i < list.size()) {
+					size_t end = list.find(',', i);
+					if (end == std::string::npos) {
+						end = list.size();
+					}
+					unsigned long first, last;
+					int const fields = sscanf(list.c_str() + i, "%lu-%lu", &first, &last);
+					if (fields == 1) {
+						last = first;
+					}
+					if (fields >= 1) {
+						for (unsigned long id = first; id <= last; id++) {
+							ids.push_back(id);
+						}
+					}
+					i = end + 1;
+				}
+				return ids;
+			}
+
+			inline std::string read_line(std::string const& path) {
+				std::string line;
+				if (FILE* f = fopen(path.c_str(), "r")) {
+					char buf[4096];
+					if (fgets(buf, sizeof(buf), f)) {
+						line = buf;
+					}
+					fclose(f);
+				}
+				return line;
+			}
+		}
+
+		/**
+		 * \brief The online NUMA nodes (just node 0 without NUMA support)
+		 */
+		inline std::vector<size_t> nodes() {
+			std::vector<size_t> ids = detail::parse_list(detail::read_line("/sys/devices/system/node/online"));
+			if (ids.empty()) {
+				ids.push_back(0);
+			}
+			return ids;
+		}
+
+		/**
+		 * \brief The node of `cpu`, or 0 if unknown
+		 */
+		inline size_t node_of_cpu(size_t cpu) {
+			for (size_t node : nodes()) {
+				std::string const path = "/sys/devices/system/node/node" + std::to_string(node) + "/cpulist";
+				for (size_t c : detail::parse_list(detail::read_line(path))) {
+					if (c == cpu) {
+						return node;
+					}
+				}
+			}
+			return 0;
+		}
+
+		/**
+		 * \brief The node holding the page at `p`
+		 *
+		 * \returns -1 if the page is not mapped, not yet touched, or the
+		 * 			kernel does not support NUMA
+		 */
+		inline int node_of(void const* p) {
+#ifdef SYS_move_pages
+			void* page = const_cast<void*>(p);
+			int status = -1;
+			// With no target nodes, move_pages only reports where the pages are
+			if (syscall(SYS_move_pages, 0, 1ul, &page, nullptr, &status, 0) == 0 && status >= 0) {
+				return status;
+			}
+#else
+			(void)p;
+#endif
+			return -1;
+		}
+
+		namespace detail {
+			// Unmaps the storage of a partitioned_array
+			struct unmapper {
+				size_t bytes;
+				void operator()(void* p) const noexcept { munmap(p, bytes); }
+			};
+		}
+	}
+
+	inline namespace SCIMD_ISA_NAMESPACE {
+		/**
+		 * \brief An array split into one partition per thread of a pool, each
+		 * 		  first touched by the thread that owns it
+		 *
+		 * Partition `t` is the static block [n * t / threads, n * (t + 1) / threads),
+		 * with the bounds rounded down to a multiple of the page size (and the
+		 * pack size). The storage is mapped directly from the kernel, so it
+		 * starts on a fresh, untouched page and no page is shared by two
+		 * partitions. The elements are zero after construction.
+		 *
+		 * for_each_partition() runs a loop over each partition on its owner via
+		 * thread_pool::broadcast, so the accesses stay on the local node. The
+		 * pool must outlive the array and should pin its workers (the default).
+		 */
+		template <typename T>
+		class partitioned_array {
+			// The storage is zeroed and released without calling constructors or destructors
+			static_assert(std::is_trivially_copyable<T>::value && std::is_trivially_default_constructible<T>::value,
+				"partitioned_array needs a trivially copyable and trivially default constructible T");
+
+		public:
+			using value_type = T;
+
+			struct partition {
+				size_t begin, end;
+				int node;	// The node that holds the partition's first page, or -1
+			};
+
+			partitioned_array(thread_pool& pool, size_t n)
+				: pool_(pool), size_{n}, parts_(pool.size()) {
+				size_t const page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+				// Never zero, so that the mapping is valid for an empty array
+				size_t const bytes = (std::max<size_t>(1, n * sizeof(T)) + page - 1) / page * page;
+				void* const p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+				if (p == MAP_FAILED) {
+					throw std::bad_alloc{};
+				}
+				// Owned from here on, so that a throwing broadcast unmaps it
+				data_ = std::unique_ptr<T, numa::detail::unmapper>{static_cast<T*>(p), numa::detail::unmapper{bytes}};
+				size_t const step = std::max(pack<T>::size, page / sizeof(T));
+				for (size_t t = 0; t < parts_.size(); t++) {
+					parts_[t].begin = (t == 0) ? 0 : (n * t / parts_.size()) / step * step;
+					parts_[t].node = -1;
+				}
+				for (size_t t = 0; t < parts_.size(); t++) {
+					parts_[t].end = (t + 1 < parts_.size()) ? parts_[t + 1].begin : n;
+				}
+
+				// The first touch decides the placement
+				T* const data = data_.get();
+				auto& parts = parts_;
+				pool_.broadcast([data, &parts](size_t t) {
+					std::fill(data + parts[t].begin, data + parts[t].end, T{0});
+					if (parts[t].begin == parts[t].end) {
+						return;
+					}
+					parts[t].node = numa::node_of(data + parts[t].begin);
+					if (parts[t].node < 0) {
+						int const cpu = sched_getcpu();
+						parts[t].node = (cpu < 0) ? 0 : static_cast<int>(numa::node_of_cpu(static_cast<size_t>(cpu)));
+					}
+				});
+			}
+			partitioned_array(partitioned_array const&) = delete;
+			partitioned_array& operator=(partitioned_array const&) = delete;
+
+			size_t size() const noexcept { return size_; }
+			T* data() noexcept { return data_.get(); }
+			T const* data() const noexcept { return data_.get(); }
+			T& operator[](size_t i) noexcept { return data_.get()[i]; }
+			T const& operator[](size_t i) const noexcept { return data_.get()[i]; }
+
+			/**
+			 * \brief The partition of each thread of the pool
+			 */
+			std::vector<partition> const& partitions() const noexcept { return parts_; }
+
+			/**
+			 * \brief Call f(begin, end) for each partition on the thread that owns it
+			 *
+			 * `begin` is a multiple of pack<T>::size.
+			 */
+			template <typename F>
+			void for_each_partition(F f) const {
+				auto const& parts = parts_;
+				pool_.broadcast([&parts, &f](size_t t) {
+					if (parts[t].begin != parts[t].end) {
+						f(parts[t].begin, parts[t].end);
+					}
+				});
+			}
+
+		private:
+			thread_pool& pool_;
+			size_t size_;
+			std::vector<partition> parts_;
+			std::unique_ptr<T, numa::detail::unmapper> data_;
+		};
+	}
+}
@@ -0,0 +1,347 @@
+#pragma once
+
+#include "scimd.hpp"
+#include "thread_pool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * 	Parallel SIMD algorithms
+ *
+ * 	These apply a function over pack<T> to a contiguous array, split across
+ * 	the threads of a thread_pool (the default_pool() if none is given).
+ * 	Each call
+ *
+ * 		1. peels elements with a masked load/store until the output (or,
+ * 		   for transform_reduce, the input) is aligned,
+ * 		2. splits the whole packs that follow into chunks sized to fill
+ * 		   about half of the L2 cache and runs them on the pool using
+ * 		   aligned stores (and aligned loads where the input shares the
+ * 		   output's alignment), and
+ * 		3. finishes the remaining elements with a masked load/store.
+ *
+ * 	When the output of transform or copy is larger than the last-level
+ * 	cache, step 2 uses streaming stores (see memory::streaming) instead.
+ * 	The output would not stay in cache anyway, and this saves reading it
+ * 	in before it is overwritten.
+ *
+ * 	The function is called concurrently from several threads, so it must
+ * 	not modify shared state. In the peeled and tail packs, the lanes past
+ * 	the end of the range hold zeros; their results are discarded.
+ */
+namespace scimd { inline namespace SCIMD_ISA_NAMESPACE {
+
+	/**
+	 * \brief Reduction operations for transform_reduce
+	 *
+	 * A reduction provides its identity, the pack-wise and scalar operations,
+	 * and the horizontal reduction of a pack. User-defined reductions need
+	 * the same four members.
+	 */
+	template <typename T> using plus = detail::reduce_add_op<T>;
+	template <typename T> using multiplies = detail::reduce_mul_op<T>;
+	template <typename T> using minimum = detail::reduce_min_op<T>;
+	template <typename T> using maximum = detail::reduce_max_op<T>;
+
+	namespace detail {
+		template <typename T>
+		bool is_aligned(T const* p) noexcept {
+			return reinterpret_cast<uintptr_t>(p) % sizeof(typename pack<T>::simd_t) == 0;
+		}
+
+		// The number of elements before `p` is aligned for pack<T>, at most `n`
+		template <typename T>
+		size_t peel(T const* p, size_t n) noexcept {
+			constexpr size_t align = sizeof(typename pack<T>::simd_t);
+			size_t const offset = reinterpret_cast<uintptr_t>(p) % align;
+			return std::min(n, ((align - offset) % align) / sizeof(T));
+		}
+
+		// A multiple of the pack size whose data fills about half of the L2 cache
+		template <typename T>
+		size_t chunk_size(size_t bytes_per_element) {
+			constexpr size_t N = pack<T>::size;
+			size_t const n = memory::cache_size(2) / 2 / bytes_per_element;
+			return std::max(N, n - n % N);
+		}
+
+		/*
+		 * 	Call body(begin, end) over [0, n) in chunks on the pool
+		 *
+		 * 	`n` is a multiple of the pack size, as are the chunk bounds.
+		 */
+		template <typename T, typename Body>
+		void parallel_chunks(thread_pool& pool, size_t n, size_t bytes_per_element, Body const& body) {
+			size_t const chunk = chunk_size<T>(bytes_per_element);
+			size_t const tasks = (n + chunk - 1) / chunk;
+			pool.run(tasks, [&body, chunk, n](size_t t) {
+				size_t const begin = t * chunk;
+				body(begin, std::min(n, begin + chunk));
+			});
+		}
+
+		template <typename T, typename UnaryOp>
+		void transform_n(T const* in, T* out, size_t n, UnaryOp const& op) {
+			if (n == 0) {
+				return;
+			}
+			pack<T> x;
+			x.load_n(in, n);
+			op(x).store_n(out, n);
+		}
+		template <typename T, typename BinaryOp>
+		void transform_n(T const* in1, T const* in2, T* out, size_t n, BinaryOp const& op) {
+			if (n == 0) {
+				return;
+			}
+			pack<T> x, y;
+			x.load_n(in1, n);
+			y.load_n(in2, n);
+			op(x, y).store_n(out, n);
+		}
+
+		// Whether an output of `n` T's should bypass the caches
+		template <typename T>
+		bool use_streaming(size_t n) {
+			static size_t const llc = memory::cache_size(3);
+			return n * sizeof(T) > llc;
+		}
+
+		template <typename Align, typename Store, typename T, typename UnaryOp>
+		void transform_packs(T const* in, T* out, size_t n, UnaryOp const& op) {
+			for (size_t i = 0; i < n; i += pack<T>::size) {
+				pack<T> x;
+				x.load(Align{}, in + i);
+				op(x).store(Store{}, out + i);
+			}
+		}
+		template <typename Align1, typename Align2, typename Store, typename T, typename BinaryOp>
+		void transform_packs(T const* in1, T const* in2, T* out, size_t n, BinaryOp const& op) {
+			for (size_t i = 0; i < n; i += pack<T>::size) {
+				pack<T> x, y;
+				x.load(Align1{}, in1 + i);
+				y.load(Align2{}, in2 + i);
+				op(x, y).store(Store{}, out + i);
+			}
+		}
+
+		// Pick the loads for the alignment of the inputs
+		template <typename Store, typename T, typename UnaryOp>
+		void transform_chunk(T const* in, T* out, size_t n, bool aligned, UnaryOp const& op) {
+			if (aligned) {
+				transform_packs<memory::aligned, Store>(in, out, n, op);
+			} else {
+				transform_packs<memory::unaligned, Store>(in, out, n, op);
+			}
+		}
+		template <typename Store, typename T, typename BinaryOp>
+		void transform_chunk(T const* in1, T const* in2, T* out, size_t n, bool aligned1, bool aligned2, BinaryOp const& op) {
+			using A = memory::aligned;
+			using U = memory::unaligned;
+			if (aligned1 && aligned2) {
+				transform_packs<A, A, Store>(in1, in2, out, n, op);
+			} else if (aligned1) {
+				transform_packs<A, U, Store>(in1, in2, out, n, op);
+			} else if (aligned2) {
+				transform_packs<U, A, Store>(in1, in2, out, n, op);
+			} else {
+				transform_packs<U, U, Store>(in1, in2, out, n, op);
+			}
+		}
+
+		// Four accumulators hide the latency of the reduction (see reduce above)
+		template <typename T, typename Reduce, typename UnaryOp>
+		T transform_reduce_packs(T const* in, size_t n, Reduce const& reduce, UnaryOp const& op) {
+			using P = pack<T>;
+			constexpr size_t N = P::size;
+			P acc0{reduce.identity()}, acc1{acc0}, acc2{acc0}, acc3{acc0}, x;
+			size_t const n4 = n - n % (4 * N);
+			size_t i = 0;
+			for (; i < n4; i += 4 * N) {
+				x.load(memory::aligned{}, in + i);			acc0 = reduce(acc0, op(x));
+				x.load(memory::aligned{}, in + i + N);		acc1 = reduce(acc1, op(x));
+				x.load(memory::aligned{}, in + i + 2 * N);	acc2 = reduce(acc2, op(x));
+				x.load(memory::aligned{}, in + i + 3 * N);	acc3 = reduce(acc3, op(x));
+			}
+			for (; i < n; i += N) {
+				x.load(memory::aligned{}, in + i);
+				acc0 = reduce(acc0, op(x));
+			}
+			return reduce(reduce(reduce(acc0, acc1), reduce(acc2, acc3)));
+		}
+
+		// The lanes past `n` are replaced by the identity
+		template <typename T, typename Reduce, typename UnaryOp>
+		T transform_reduce_n(T const* in, size_t n, Reduce const& reduce, UnaryOp const& op) {
+			if (n == 0) {
+				return reduce.identity();
+			}
+			pack<T> x;
+			x.load_n(in, n);
+			pack<T> result{reduce.identity()};
+			result.blend(op(x), first_lanes<T>(n));
+			return reduce(result);
+		}
+	}
+
+	/**
+	 * \brief Call body(begin, end) on the pool for chunks covering [0, n)
+	 *
+	 * This is for loops that the algorithms below do not fit, such as those
+	 * over several arrays or with uneven per-element costs. Every chunk except
+	 * the last is `chunk` elements rounded up to a multiple of pack<T>::size,
+	 * so each one starts on a pack boundary. By default, a chunk of T's fills
+	 * about half of the L2 cache. For uneven costs, a smaller chunk gives the
+	 * pool more tasks to balance with.
+	 */
+	template <typename T, typename Body>
+	void parallel_for(thread_pool& pool, size_t n, Body body, size_t chunk = 0) {
+		constexpr size_t N = pack<T>::size;
+		chunk = (chunk == 0) ? detail::chunk_size<T>(sizeof(T)) : (chunk + N - 1) / N * N;
+		pool.run((n + chunk - 1) / chunk, [&body, chunk, n](size_t t) {
+			size_t const begin = t * chunk;
+			body(begin, std::min(n, begin + chunk));
+		});
+	}
+	template <typename T, typename Body>
+	void parallel_for(size_t n, Body body, size_t chunk = 0) {
+		parallel_for<T>(default_pool(), n, body, chunk);
+	}
+
+	/**
+	 * \brief out[i] = op(first[i]) for i in [0, last - first)
+	 *
+	 * `op` takes and returns a pack<T>. The ranges may be the same but
+	 * must not otherwise overlap.
+	 *
+	 * \returns The end of the output
+	 */
+	template <typename T, typename UnaryOp>
+	T* transform(thread_pool& pool, T const* first, T const* last, T* out, UnaryOp op) {
+		constexpr size_t N = pack<T>::size;
+		size_t const n = static_cast<size_t>(last - first);
+		size_t const head = detail::peel(out, n);
+		size_t const body = (n - head) - (n - head) % N;
+
+		detail::transform_n(first, out, head, op);
+		T const* in = first + head;
+		T* dst = out + head;
+		bool const aligned = detail::is_aligned(in);
+		bool const stream = detail::use_streaming<T>(n);
+		detail::parallel_chunks<T>(pool, body, 2 * sizeof(T), [in, dst, aligned, stream, &op](size_t begin, size_t end) {
+			if (stream) {
+				detail::transform_chunk<memory::streaming>(in + begin, dst + begin, end - begin, aligned, op);
+				memory::sfence();
+			} else {
+				detail::transform_chunk<memory::aligned>(in + begin, dst + begin, end - begin, aligned, op);
+			}
+		});
+		detail::transform_n(in + body, dst + body, n - head - body, op);
+		return out + n;
+	}
+	template <typename T, typename UnaryOp>
+	T* transform(T const* first, T const* last, T* out, UnaryOp op) {
+		return transform(default_pool(), first, last, out, op);
+	}
+
+	/**
+	 * \brief out[i] = op(first1[i], first2[i]) for i in [0, last1 - first1)
+	 */
+	template <typename T, typename BinaryOp>
+	T* transform(thread_pool& pool, T const* first1, T const* last1, T const* first2, T* out, BinaryOp op) {
+		constexpr size_t N = pack<T>::size;
+		size_t const n = static_cast<size_t>(last1 - first1);
+		size_t const head = detail::peel(out, n);
+		size_t const body = (n - head) - (n - head) % N;
+
+		detail::transform_n(first1, first2, out, head, op);
+		T const* in1 = first1 + head;
+		T const* in2 = first2 + head;
+		T* dst = out + head;
+		bool const aligned1 = detail::is_aligned(in1), aligned2 = detail::is_aligned(in2);
+		bool const stream = detail::use_streaming<T>(n);
+		detail::parallel_chunks<T>(pool, body, 3 * sizeof(T), [=, &op](size_t begin, size_t end) {
+			size_t const m = end - begin;
+			if (stream) {
+				detail::transform_chunk<memory::streaming>(in1 + begin, in2 + begin, dst + begin, m, aligned1, aligned2, op);
+				memory::sfence();
+			} else {
+				detail::transform_chunk<memory::aligned>(in1 + begin, in2 + begin, dst + begin, m, aligned1, aligned2, op);
+			}
+		});
+		detail::transform_n(in1 + body, in2 + body, dst + body, n - head - body, op);
+		return out + n;
+	}
+	template <typename T, typename BinaryOp>
+	T* transform(T const* first1, T const* last1, T const* first2, T* out, BinaryOp op) {
+		return transform(default_pool(), first1, last1, first2, out, op);
+	}
+
+	/**
+	 * \brief Copy [first, last) to `out`
+	 *
+	 * Unlike std::copy, this bypasses the caches for outputs larger than
+	 * the last-level cache. The ranges must not overlap.
+	 *
+	 * \returns The end of the output
+	 */
+	template <typename T>
+	T* copy(thread_pool& pool, T const* first, T const* last, T* out) {
+		return transform(pool, first, last, out, [](pack<T> x) { return x; });
+	}
+	template <typename T>
+	T* copy(T const* first, T const* last, T* out) {
+		return copy(default_pool(), first, last, out);
+	}
+
+	/**
+	 * \brief Call f(x) on each pack of [first, last) and store x back
+	 *
+	 * `f` takes a pack<T>& and may modify it.
+	 */
+	template <typename T, typename UnaryFunc>
+	void for_each(thread_pool& pool, T* first, T* last, UnaryFunc f) {
+		transform(pool, static_cast<T const*>(first), static_cast<T const*>(last), first, [&f](pack<T> x) {
+			f(x);
+			return x;
+		});
+	}
+	template <typename T, typename UnaryFunc>
+	void for_each(T* first, T* last, UnaryFunc f) {
+		for_each(default_pool(), first, last, f);
+	}
+
+	/**
+	 * \brief Reduce op(first[i]) over [first, last), starting from `init`
+	 *
+	 * `reduce` is plus, multiplies, minimum, maximum, or a type with the same
+	 * members. The result is the same for any number of threads, but it is not
+	 * bitwise identical to a serial loop (see reduce_add).
+	 */
+	template <typename T, typename Reduce, typename UnaryOp>
+	T transform_reduce(thread_pool& pool, T const* first, T const* last, T init, Reduce reduce, UnaryOp op) {
+		constexpr size_t N = pack<T>::size;
+		size_t const n = static_cast<size_t>(last - first);
+		size_t const head = detail::peel(first, n);
+		size_t const body = (n - head) - (n - head) % N;
+		T const* in = first + head;
+
+		size_t const chunk = detail::chunk_size<T>(sizeof(T));
+		std::vector<T> partial((body + chunk - 1) / chunk);
+		pool.run(partial.size(), [&partial, &reduce, &op, in, chunk, body](size_t t) {
+			size_t const begin = t * chunk;
+			partial[t] = detail::transform_reduce_packs(in + begin, std::min(body, begin + chunk) - begin, reduce, op);
+		});
+
+		T result = reduce(init, detail::transform_reduce_n(first, head, reduce, op));
+		for (auto x : partial) {
+			result = reduce(result, x);
+		}
+		return reduce(result, detail::transform_reduce_n(in + body, n - head - body, reduce, op));
+	}
+	template <typename T, typename Reduce, typename UnaryOp>
+	T transform_reduce(T const* first, T const* last, T init, Reduce reduce, UnaryOp op) {
+		return transform_reduce(default_pool(), first, last, init, reduce, op);
+	}
+}}
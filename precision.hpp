@@ -0,0 +1,30 @@
+#pragma once
+
+namespace scimd {
+	namespace precision {
+		/**
+		 * \brief Accuracy of rsqrt, rcp, div, and sqrt
+		 *
+		 * fast: The raw hardware estimate. This has a relative error of
+		 * 		 1.5*2^-12 on SSE and AVX, 2^-14 on AVX-512, and 2^-28 on
+		 * 		 Knights Landing. The SSE and AVX double-precision estimates
+		 * 		 go through single precision, so their arguments must be
+		 * 		 within the range of float.
+		 *
+		 * standard: The estimate refined to nearly full precision (about
+		 * 			 23 bits for float and 51 bits for double). This is the
+		 * 			 default. The SSE and AVX double-precision versions fall
+		 * 			 back to IEEE square root and division for arguments
+		 * 			 outside the range of float. div multiplies by the
+		 * 			 reciprocal, so it overflows where 1/y does.
+		 *
+		 * exact: IEEE square root and division. rcp and div are correctly
+		 * 		  rounded; rsqrt is rounded twice.
+		 *
+		 * \note The middle level would be named `default`, but that is a keyword.
+		 */
+		struct fast{};
+		struct standard{};
+		struct exact{};
+	}
+}
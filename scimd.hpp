@@ -5,26 +5,74 @@
  *  SIMD modes is expensive on even modern CPUs. If you need to use
  *  more than one instruction set, put them in separate translation
  *  units.
+ *
+ *  Everything that depends on the instruction set lives in an inline
+ *  namespace named for it (e.g., scimd::isa_avx). This keeps the one-
+ *  definition rule intact when those translation units are linked into
+ *  the same binary (see dispatch.hpp).
+ *
+ *  The AVX-512 backend only requires AVX512F. On Knights Landing
+ *  (AVX512ER+PF), it additionally uses the higher-precision estimates.
  */
-#if defined(__AVX512F__) && defined(__AVX512ER__) && defined(__AVX512PF__) && defined(__AVX512CD__) && !defined(SCIMD_DISABLE_AVX512)
+#if defined(__AVX512F__) && !defined(SCIMD_DISABLE_AVX512)
+	#if defined(__AVX512ER__) && defined(__AVX512PF__)
+		#define SCIMD_ISA knl
+		#define SCIMD_ISA_NAMESPACE isa_knl
+	#else
+		#define SCIMD_ISA avx512
+		#define SCIMD_ISA_NAMESPACE isa_avx512
+	#endif
 	#include "arch/avx512.hpp"
 #elif defined(__AVX__) && !defined(SCIMD_DISABLE_AVX)
+	#if defined(__AVX2__) && defined(__FMA__)
+		#define SCIMD_ISA avx2
+		#define SCIMD_ISA_NAMESPACE isa_avx2
+	#else
+		#define SCIMD_ISA avx
+		#define SCIMD_ISA_NAMESPACE isa_avx
+	#endif
 	#include "arch/avx.hpp"
 #elif defined(__SSE4_2__) && !defined(SCIMD_DISABLE_SSE)
+	#define SCIMD_ISA sse
+	#define SCIMD_ISA_NAMESPACE isa_sse
 	#include "arch/sse.hpp"
 #else
+	#define SCIMD_ISA scalar
+	#define SCIMD_ISA_NAMESPACE isa_scalar
 	#include "arch/scalar.hpp"
 #endif
 
 #include "arch/traits.hpp"
+#include "precision.hpp"
 #include "memory.hpp"
+#include "dispatch.hpp"
+
+#include <algorithm>
+#include <limits>
 
-namespace scimd {
+namespace scimd { inline namespace SCIMD_ISA_NAMESPACE {
 
+	/**
+	 * \brief The instruction set this translation unit was compiled for
+	 */
+	constexpr dispatch::isa current_isa = dispatch::isa::SCIMD_ISA;
+
+	/**
+	 * \brief The result of comparing packs: one boolean per lane
+	 *
+	 * The logical operators work lane-wise in the backend's mask registers,
+	 * so `r < rcut && active` costs a single instruction. Both operands are
+	 * always evaluated.
+	 */
 	template <typename T>
 	struct conditional_t {
 		typename T::bool_t val;
 		conditional_t(typename T::bool_t val) : val(val) {}
+
+		conditional_t operator &&(conditional_t x) const { return logical_and(val, x.val, typename T::value_type{}, typename T::category{}); }
+		conditional_t operator ||(conditional_t x) const { return logical_or (val, x.val, typename T::value_type{}, typename T::category{}); }
+		conditional_t operator ^ (conditional_t x) const { return logical_xor(val, x.val, typename T::value_type{}, typename T::category{}); }
+		conditional_t operator !()                 const { return logical_not(val,        typename T::value_type{}, typename T::category{}); }
 	};
 
 	template <typename T>
@@ -88,10 +136,24 @@ namespace scimd {
 		value_type const* load(memory::unaligned, value_type const* p) { return this->load(p, memory::unaligned{}); }
 		value_type const* load(memory::aligned,   value_type const* p) { return this->load(p, memory::aligned{}); }
 
+		/**
+		 * \brief Load the first `n` elements of a pack from memory
+		 *
+		 * Lanes at or beyond `n` are set to zero. Memory past `p + n` is never
+		 * touched, so this is safe for the tail of an array.
+		 *
+		 * \pre n <= size
+		 */
+		value_type const* load_n(value_type const* p, size_t n) {
+			val = ::scimd::load_n(p, n, T{}, category{});
+			return p + n;
+		}
+
 		/**
 		 * \brief Load a pack from memory using the supplied function
 		 *
 		 * This is primarily intended for AoS->SoA conversions as it has very high overhead compared to `load(T*)`.
+		 * For the tail of a contiguous array, use `load_n` instead.
 		 */
 		template <typename FwdIter, typename UnaryFunc>
 		FwdIter load(memory::ragged, FwdIter beg, FwdIter end, UnaryFunc f, value_type default_val) {
@@ -139,6 +201,23 @@ namespace scimd {
 		value_type* store(memory::unaligned, value_type* p) { return this->store(p, memory::unaligned{}); }
 		value_type* store(memory::aligned,   value_type* p) { return this->store(p, memory::aligned{}); }
 
+		/**
+		 * \brief Store to aligned memory, bypassing the caches
+		 *
+		 * See memory::streaming.
+		 */
+		value_type* store(memory::streaming, value_type* p) { return this->store(p, memory::streaming{}); }
+
+		/**
+		 * \brief Store the first `n` elements of a pack to memory
+		 *
+		 * \pre n <= size
+		 */
+		value_type* store_n(value_type* p, size_t n) {
+			::scimd::store_n(p, n, val, T{}, category{});
+			return p + n;
+		}
+
 		/* --- Scalar versions --- */
 		template <typename FwdIter, typename BinaryFunc>
 		typename std::enable_if<is_scalar<category>::value, FwdIter>::type
@@ -186,6 +265,196 @@ namespace scimd {
 			return this->store(memory::ragged{}, beg, end, f);
 		}
 	};
+
+	/*
+	 * 	The register width comes from the pack of floats so that this works
+	 * 	for any T (e.g., the int32_t indices). Only the scalar pack<double>
+	 * 	is wider, which alignof(T) covers.
+	 */
+	template <typename T>
+	struct pack_alignment
+		: std::integral_constant<size_t, (alignof(T) > sizeof(pack<float>)) ? alignof(T) : sizeof(pack<float>)> {};
+
+	/**
+	 * \brief One index of type I per lane of a pack<T>
+	 *
+	 * Used with gather/scatter for lookup tables and array-of-structures
+	 * access. Indices are in units of elements, not bytes. The int32_t
+	 * indices reach 2^31 elements; for larger double arrays, use
+	 * index_pack<double, int64_t> (the 64-bit gathers on AVX2 and AVX-512).
+	 */
+	template <typename T, typename I = int32_t>
+	struct index_pack {
+		using value_type = I;
+		using category = simd_category::type;
+		using simd_t = typename index_type<T, I>::type;
+		static constexpr auto size = pack<T>::size;
+
+		simd_t val;
+
+		explicit index_pack() : val{} {}
+		index_pack(simd_t x) : val(x) {}
+
+		value_type const* load(value_type const* p) {
+			val = load_index(p, T{}, category{});
+			return p + size;
+		}
+		value_type* store(value_type* p) {
+			store_index(p, val, T{}, category{});
+			return p + size;
+		}
+	};
+
+	/* ----------------------------------------------------------
+	 * 			Array Reductions
+	 *---------------------------------------------------------*/
+	namespace detail {
+		template <typename T>
+		struct reduce_add_op {
+			using P = pack<T>;
+			static T identity() { return T{0}; }
+			P operator()(P x, P y) const { return x + y; }
+			T operator()(T x, T y) const { return x + y; }
+			T operator()(P x) const { return reduce_add(x.val, T{}, typename P::category{}); }
+		};
+		template <typename T>
+		struct reduce_mul_op {
+			using P = pack<T>;
+			static T identity() { return T{1}; }
+			P operator()(P x, P y) const { return x * y; }
+			T operator()(T x, T y) const { return x * y; }
+			T operator()(P x) const { return reduce_mul(x.val, T{}, typename P::category{}); }
+		};
+		template <typename T>
+		struct reduce_min_op {
+			using P = pack<T>;
+			static T identity() { return std::numeric_limits<T>::infinity(); }
+			P operator()(P x, P y) const { return ::scimd::min(x.val, y.val, T{}, typename P::category{}); }
+			T operator()(T x, T y) const { return std::min(x, y); }
+			T operator()(P x) const { return reduce_min(x.val, T{}, typename P::category{}); }
+		};
+		template <typename T>
+		struct reduce_max_op {
+			using P = pack<T>;
+			static T identity() { return -std::numeric_limits<T>::infinity(); }
+			P operator()(P x, P y) const { return ::scimd::max(x.val, y.val, T{}, typename P::category{}); }
+			T operator()(T x, T y) const { return std::max(x, y); }
+			T operator()(P x) const { return reduce_max(x.val, T{}, typename P::category{}); }
+		};
+
+		/**
+		 * 	Four independent accumulators are kept in flight so that
+		 * 	consecutive iterations do not wait on the latency of the
+		 * 	previous add/mul (4 cycles on Skylake with two ports).
+		 */
+		template <typename T, typename Op>
+		T reduce(T const* p, size_t n, Op op) {
+			using P = pack<T>;
+			constexpr size_t N = P::size;
+			P acc0{op.identity()}, acc1{acc0}, acc2{acc0}, acc3{acc0}, x;
+			size_t const n4 = n - n % (4 * N), n1 = n - n % N;
+			size_t i = 0;
+			for (; i < n4; i += 4 * N) {
+				x.load(p + i);			acc0 = op(acc0, x);
+				x.load(p + i + N);		acc1 = op(acc1, x);
+				x.load(p + i + 2 * N);	acc2 = op(acc2, x);
+				x.load(p + i + 3 * N);	acc3 = op(acc3, x);
+			}
+			for (; i < n1; i += N) {
+				x.load(p + i);
+				acc0 = op(acc0, x);
+			}
+			T result = op(op(op(acc0, acc1), op(acc2, acc3)));
+			for (; i < n; i++) {
+				result = op(result, p[i]);
+			}
+			return result;
+		}
+	}
+
+	/**
+	 * \brief Reduce `n` contiguous values
+	 *
+	 * The order of operations differs from a serial loop, so reduce_add and
+	 * reduce_mul are not bitwise identical to std::accumulate.
+	 *
+	 * An empty range returns the identity (0, 1, +inf, and -inf, respectively).
+	 */
+	template <typename T>
+	T reduce_add(T const* p, size_t n) { return detail::reduce(p, n, detail::reduce_add_op<T>{}); }
+	template <typename T>
+	T reduce_mul(T const* p, size_t n) { return detail::reduce(p, n, detail::reduce_mul_op<T>{}); }
+	template <typename T>
+	T reduce_min(T const* p, size_t n) { return detail::reduce(p, n, detail::reduce_min_op<T>{}); }
+	template <typename T>
+	T reduce_max(T const* p, size_t n) { return detail::reduce(p, n, detail::reduce_max_op<T>{}); }
+
+	/* ----------------------------------------------------------
+	 * 			Reciprocals
+	 *
+	 * 	The backends provide the default-precision rsqrt/rcp and
+	 * 	the raw estimates (precision::fast). The other two levels
+	 * 	are the same for every instruction set.
+	 *---------------------------------------------------------*/
+	template <typename S, typename T, typename Tag>
+	S rsqrt(S x, T, Tag, precision::standard) { return rsqrt(x, T{}, Tag{}); }
+	template <typename S, typename T, typename Tag>
+	S rsqrt(S x, T, Tag, precision::exact) { return div(set1(T{1}, T{}, Tag{}), sqrt(x, T{}, Tag{}), T{}, Tag{}); }
+	template <typename S, typename T, typename Tag>
+	S rcp(S x, T, Tag, precision::standard) { return rcp(x, T{}, Tag{}); }
+	template <typename S, typename T, typename Tag>
+	S rcp(S x, T, Tag, precision::exact) { return div(set1(T{1}, T{}, Tag{}), x, T{}, Tag{}); }
+
+	template <typename S, typename T, typename Tag, typename Precision>
+	S div(S x, S y, T, Tag, Precision) { return mul(x, rcp(y, T{}, Tag{}, Precision{}), T{}, Tag{}); }
+	template <typename S, typename T, typename Tag>
+	S div(S x, S y, T, Tag, precision::exact) { return div(x, y, T{}, Tag{}); }
+
+	template <typename S, typename T, typename Tag, typename Precision>
+	S div_sqrt(S x, S y, T, Tag, Precision) { return mul(x, rsqrt(y, T{}, Tag{}, Precision{}), T{}, Tag{}); }
+	template <typename S, typename T, typename Tag>
+	S div_sqrt(S x, S y, T, Tag, precision::exact) { return div(x, sqrt(y, T{}, Tag{}), T{}, Tag{}); }
+
+	/* ----------------------------------------------------------
+	 * 			Compress
+	 *
+	 * 	AVX-512 stores the selected lanes directly. Elsewhere, they
+	 * 	are compressed in a register and then partially stored.
+	 *---------------------------------------------------------*/
+	template <typename S, typename B, typename T, typename Tag>
+	size_t compress_store(T* p, S x, B mask, T, Tag) {
+		size_t const n = logical_count(mask, T{}, Tag{});
+		store_n(p, n, compress(x, mask, T{}, Tag{}), T{}, Tag{});
+		return n;
+	}
+
+	namespace detail {
+		// true for lanes [0, n) of a partial pack, n < pack<T>::size
+		template <typename T>
+		conditional_t<pack<T>> first_lanes(size_t n) {
+			return from_bits((uint32_t{1} << n) - 1, T{}, typename pack<T>::category{});
+		}
+	}
+}}
+
+/* ----------------------------------------------------------
+ * 			Gather/Scatter
+ *---------------------------------------------------------*/
+/**
+ * \brief Load `base[idx[i]]` into lane `i`
+ */
+template <typename T, typename I>
+inline scimd::pack<T> gather(T const* base, scimd::index_pack<T, I> idx) {
+	return scimd::gather(base, idx.val, T{}, I{}, typename scimd::pack<T>::category{});
+}
+/**
+ * \brief Store lane `i` into `base[idx[i]]`
+ *
+ * If indices repeat, the highest lane wins.
+ */
+template <typename T, typename I>
+inline void scatter(T* base, scimd::index_pack<T, I> idx, scimd::pack<T> x) {
+	scimd::scatter(base, idx.val, x.val, T{}, I{}, typename scimd::pack<T>::category{});
 }
 
 /* ----------------------------------------------------------
@@ -212,6 +481,44 @@ inline abs(scimd::pack<T> x) {
 	return abs(x, typename scimd::pack<T>::value_type{}, typename scimd::pack<T>::category{});
 }
 
+/* ----------------------------------------------------------
+ * 			Fused Multiply-Add Functions
+ *
+ * 	fma(a,b,c)  =  a*b + c		fms(a,b,c)  =  a*b - c
+ * 	fnma(a,b,c) = -a*b + c		fnms(a,b,c) = -a*b - c
+ *
+ * 	These are a single instruction (and a single rounding) when
+ * 	the target has FMA; otherwise, a separate multiply and add.
+ *---------------------------------------------------------*/
+template <typename T>
+inline scimd::pack<T> fma(scimd::pack<T> a, scimd::pack<T> b, scimd::pack<T> c) {
+	return scimd::fma(a.val, b.val, c.val, typename scimd::pack<T>::value_type{}, typename scimd::pack<T>::category{});
+}
+template <typename T>
+inline scimd::pack<T> fms(scimd::pack<T> a, scimd::pack<T> b, scimd::pack<T> c) {
+	return scimd::fms(a.val, b.val, c.val, typename scimd::pack<T>::value_type{}, typename scimd::pack<T>::category{});
+}
+template <typename T>
+inline scimd::pack<T> fnma(scimd::pack<T> a, scimd::pack<T> b, scimd::pack<T> c) {
+	return scimd::fnma(a.val, b.val, c.val, typename scimd::pack<T>::value_type{}, typename scimd::pack<T>::category{});
+}
+template <typename T>
+inline scimd::pack<T> fnms(scimd::pack<T> a, scimd::pack<T> b, scimd::pack<T> c) {
+	return scimd::fnms(a.val, b.val, c.val, typename scimd::pack<T>::value_type{}, typename scimd::pack<T>::category{});
+}
+
+/* ----------------------------------------------------------
+ * 			Horizontal Reductions
+ *---------------------------------------------------------*/
+template <typename T>
+inline T reduce_add(scimd::pack<T> x) { return scimd::reduce_add(x.val, T{}, typename scimd::pack<T>::category{}); }
+template <typename T>
+inline T reduce_mul(scimd::pack<T> x) { return scimd::reduce_mul(x.val, T{}, typename scimd::pack<T>::category{}); }
+template <typename T>
+inline T reduce_min(scimd::pack<T> x) { return scimd::reduce_min(x.val, T{}, typename scimd::pack<T>::category{}); }
+template <typename T>
+inline T reduce_max(scimd::pack<T> x) { return scimd::reduce_max(x.val, T{}, typename scimd::pack<T>::category{}); }
+
 /* ----------------------------------------------------------
  * 			Logical Functions
  *---------------------------------------------------------*/
@@ -221,6 +528,55 @@ template <typename T>
 inline bool none(scimd::conditional_t<T> x) { return scimd::logical_none(x.val, typename T::value_type{}, typename T::category{}); }
 template <typename T>
 inline bool any(scimd::conditional_t<T> x) { return !none(x); }
+/**
+ * \brief The number of set lanes
+ */
+template <typename T>
+inline size_t count(scimd::conditional_t<T> x) { return scimd::logical_count(x.val, typename T::value_type{}, typename T::category{}); }
+/**
+ * \brief The bits of the lanes, lane 0 in the least-significant bit
+ */
+template <typename T>
+inline uint32_t to_bits(scimd::conditional_t<T> x) { return scimd::to_bits(x.val, typename T::value_type{}, typename T::category{}); }
+/**
+ * \brief The mask with lane i set from bit i of `bits`, e.g., from_bits<float>(0x5)
+ */
+template <typename T>
+inline scimd::conditional_t<scimd::pack<T>> from_bits(uint32_t bits) {
+	return scimd::from_bits(bits, T{}, typename scimd::pack<T>::category{});
+}
+/**
+ * \brief The index of the first set lane, or pack<T>::size if there is none
+ */
+template <typename T>
+inline size_t find_first(scimd::conditional_t<T> x) {
+	uint32_t const bits = to_bits(x);
+	return (bits == 0) ? size_t{T::size} : static_cast<size_t>(__builtin_ctz(bits));
+}
+
+/* ----------------------------------------------------------
+ * 			Compress
+ *---------------------------------------------------------*/
+/**
+ * \brief Move the lanes selected by `mask` to the front of the pack, in order
+ *
+ * The lanes past the selected ones are unspecified.
+ */
+template <typename T>
+inline scimd::pack<T> compress(scimd::pack<T> x, scimd::conditional_t<scimd::pack<T>> mask) {
+	return scimd::compress(x.val, mask.val, T{}, typename scimd::pack<T>::category{});
+}
+/**
+ * \brief Store the lanes selected by `mask` contiguously at `p`
+ *
+ * Only the selected lanes are written (at most pack<T>::size elements).
+ *
+ * \returns The number of lanes stored
+ */
+template <typename T>
+inline size_t compress_store(T* p, scimd::pack<T> x, scimd::conditional_t<scimd::pack<T>> mask) {
+	return scimd::compress_store(p, x.val, mask.val, T{}, typename scimd::pack<T>::category{});
+}
 
 /* ----------------------------------------------------------
  * 			Binary Arithmetic Operators
@@ -247,7 +603,11 @@ scimd::conditional_t<scimd::pack<T>> operator >=(typename scimd::pack<T>::value_
 /* ----------------------------------------------------------
  * 			Square-root Helpers
  *---------------------------------------------------------*/
-template <typename T>
+/**
+ * 	The precision only applies to dividing by the proxy (see below). Converting
+ * 	it to a pack always uses the IEEE square root.
+ */
+template <typename T, typename Precision = scimd::precision::standard>
 struct sqrt_proxy {
 	T value;
 	explicit sqrt_proxy(T x) : value{x} {}
@@ -256,22 +616,49 @@ struct sqrt_proxy {
 	}
 };
 
-// See the respective definitions of rsqrt for the relative errors.
+// See the respective definitions of rsqrt and rcp for the relative errors.
 template <typename T>
 scimd::pack<T> rsqrt(scimd::pack<T> x) { return rsqrt(x.val, T{}, typename scimd::pack<T>::category{}); }
+template <typename T, typename Precision>
+scimd::pack<T> rsqrt(scimd::pack<T> x, Precision) {
+	return scimd::rsqrt(x.val, T{}, typename scimd::pack<T>::category{}, Precision{});
+}
+template <typename T>
+scimd::pack<T> rcp(scimd::pack<T> x) { return scimd::rcp(x.val, T{}, typename scimd::pack<T>::category{}); }
+template <typename T, typename Precision>
+scimd::pack<T> rcp(scimd::pack<T> x, Precision) {
+	return scimd::rcp(x.val, T{}, typename scimd::pack<T>::category{}, Precision{});
+}
+
+/**
+ * \brief x / y at the given precision
+ *
+ * 	operator/ is always the IEEE division. For fast and standard, this is
+ * 	x * rcp(y, precision).
+ */
+template <typename T, typename Precision>
+scimd::pack<T> div(scimd::pack<T> x, scimd::pack<T> y, Precision) {
+	return scimd::div(x.val, y.val, T{}, typename scimd::pack<T>::category{}, Precision{});
+}
 
 /*
  * 	This allows code like `T x(4.0), y(2.0/sqrt(x));` to work correctly for
  * 	all types and uses the rsqrt optimization for T=pack.
  *
  * 	If you just need 1.0 / sqrt(x), use rsqrt directly to avoid the extra mul.
+ *
+ * 	`y / sqrt(x, precision::exact)` divides by the IEEE square root instead.
  */
-template <typename T>
-scimd::pack<T> operator/(scimd::pack<T> lhs, sqrt_proxy<scimd::pack<T>> rhs) { return lhs * rsqrt(rhs.value); }
+template <typename T, typename Precision>
+scimd::pack<T> operator/(scimd::pack<T> lhs, sqrt_proxy<scimd::pack<T>, Precision> rhs) {
+	return scimd::div_sqrt(lhs.val, rhs.value.val, T{}, typename scimd::pack<T>::category{}, Precision{});
+}
 template <typename T>
 scimd::pack<T> operator/(typename scimd::pack<T>::value_type a, scimd::pack<T> b) { return scimd::pack<T>(a) / b; }
-template <typename T>
-scimd::pack<T> operator/(typename scimd::pack<T>::value_type a, sqrt_proxy<scimd::pack<T>> rhs) { return a * rsqrt(rhs.value); }
+template <typename T, typename Precision>
+scimd::pack<T> operator/(typename scimd::pack<T>::value_type a, sqrt_proxy<scimd::pack<T>, Precision> rhs) {
+	return scimd::pack<T>(a) / rhs;
+}
 
 /**
  * 	The converting constructor for pack<T> enables this overload in dangerous
@@ -293,6 +680,15 @@ namespace {
 		return sqrt_proxy<scimd::pack<T>>(a);
 	}
 
+	template <typename T, typename Precision>
+	inline typename std::enable_if<
+						std::is_floating_point<T>::value,
+						sqrt_proxy<scimd::pack<T>, Precision>
+					>::type
+	sqrt(scimd::pack<T> a, Precision) {
+		return sqrt_proxy<scimd::pack<T>, Precision>(a);
+	}
+
 	template <typename T>
 	inline typename std::enable_if<
 						std::is_floating_point<T>::value,
@@ -0,0 +1,221 @@
+#pragma once
+
+#include "scimd.hpp"
+#include <cstddef>
+#include <initializer_list>
+#include <tuple>
+#include <vector>
+
+/**
+ * 	Structure-of-arrays storage
+ *
+ * 	soa<Fields...> keeps one column per field (e.g., soa<float, float, float>
+ * 	for x, y, z). Each column is allocated with scimd::allocator at the
+ * 	alignment of its pack and is padded with zeros to a multiple of the
+ * 	widest pack, so every pack in a column can be loaded and stored with
+ * 	memory::aligned and there is never a ragged tail.
+ *
+ * 	The padding lanes take part in pack-wise loops. Kernels that would
+ * 	divide by them (or otherwise need a different value there) should
+ * 	blend or ignore the lanes at and beyond size().
+ */
+namespace scimd { inline namespace SCIMD_ISA_NAMESPACE {
+
+	namespace detail {
+		// std::index_sequence is C++14
+		template <size_t... I> struct index_sequence {};
+		template <size_t N, size_t... I>
+		struct make_index_sequence : make_index_sequence<N - 1, N - 1, I...> {};
+		template <size_t... I>
+		struct make_index_sequence<0, I...> { using type = index_sequence<I...>; };
+
+		template <size_t... Sizes> struct max_size;
+		template <size_t S>
+		struct max_size<S> { static constexpr size_t value = S; };
+		template <size_t S, size_t... Sizes>
+		struct max_size<S, Sizes...> {
+			static constexpr size_t value = (S > max_size<Sizes...>::value) ? S : max_size<Sizes...>::value;
+		};
+
+		template <bool... B> struct all_true;
+		template <> struct all_true<> : std::true_type {};
+		template <bool... B> struct all_true<true, B...> : all_true<B...> {};
+		template <bool... B> struct all_true<false, B...> : std::false_type {};
+
+		// Allow a parameter pack to be expanded for its side effects
+		inline void expand(std::initializer_list<int>) {}
+	}
+
+	template <typename... Fields>
+	class soa {
+		static_assert(sizeof...(Fields) > 0, "An soa needs at least one field");
+		static_assert(detail::all_true<std::is_floating_point<Fields>::value...>::value,
+					  "soa fields must be floating-point types");
+
+		template <typename T>
+		using column = std::vector<T, allocator<T>>;
+		using indices = typename detail::make_index_sequence<sizeof...(Fields)>::type;
+
+	public:
+		template <size_t I>
+		using field_type = typename std::tuple_element<I, std::tuple<Fields...>>::type;
+
+		/**
+		 * \brief The number of fields and the padding of each column
+		 */
+		static constexpr size_t fields = sizeof...(Fields);
+		static constexpr size_t padding = detail::max_size<pack<Fields>::size...>::value;
+
+		soa() = default;
+		explicit soa(size_t n) { resize(n); }
+
+		size_t size() const noexcept { return size_; }
+		bool empty() const noexcept { return size_ == 0; }
+
+		/**
+		 * \brief The length of each column, including the padding
+		 */
+		size_t padded_size() const noexcept { return round_up(size_); }
+
+		/**
+		 * \brief Change the number of elements
+		 *
+		 * New elements are zero, as are the padding lanes.
+		 */
+		void resize(size_t n) {
+			size_t const padded = round_up(n);
+			resize_columns(padded, indices{});
+			if (n < size_) {
+				zero_columns(n, indices{});
+			}
+			size_ = n;
+		}
+		void reserve(size_t n) { reserve_columns(round_up(n), indices{}); }
+		void clear() { resize(0); }
+
+		void push_back(Fields... values) {
+			size_t const i = size_;
+			resize(size_ + 1);
+			set(i, std::forward_as_tuple(values...), indices{});
+		}
+
+		/**
+		 * \brief The start of column `I`
+		 *
+		 * It is aligned for pack<field_type<I>> and holds padded_size() elements.
+		 */
+		template <size_t I>
+		field_type<I>* data() noexcept { return std::get<I>(columns_).data(); }
+		template <size_t I>
+		field_type<I> const* data() const noexcept { return std::get<I>(columns_).data(); }
+
+		template <size_t I>
+		field_type<I>& get(size_t i) { return std::get<I>(columns_)[i]; }
+		template <size_t I>
+		field_type<I> const& get(size_t i) const { return std::get<I>(columns_)[i]; }
+
+		/**
+		 * \brief The fields of element `i` by reference
+		 */
+		std::tuple<Fields&...> operator[](size_t i) { return element(i, indices{}); }
+
+		/**
+		 * \brief Load/store the pack of column `I` starting at element `i`
+		 *
+		 * \pre i is a multiple of pack<field_type<I>>::size and i < padded_size()
+		 */
+		template <size_t I>
+		pack<field_type<I>> load(size_t i) const {
+			pack<field_type<I>> x;
+			x.load(memory::aligned{}, data<I>() + i);
+			return x;
+		}
+		template <size_t I>
+		void store(size_t i, pack<field_type<I>> x) {
+			x.store(memory::aligned{}, data<I>() + i);
+		}
+
+		/**
+		 * \brief Iterate over the columns one pack at a time
+		 *
+		 * Dereferencing yields a tuple with one pack per field. Assigning to
+		 * the iterator's store() writes a tuple back to the same position.
+		 * The iteration covers the padding.
+		 *
+		 * 	for (auto it = s.pack_begin(); it != s.pack_end(); ++it) {
+		 * 		auto p = *it;
+		 * 		std::get<0>(p) += std::get<1>(p);
+		 * 		it.store(p);
+		 * 	}
+		 *
+		 * \note All fields must have the same pack size (e.g., all float).
+		 */
+		class pack_iterator {
+		public:
+			using value_type = std::tuple<pack<Fields>...>;
+			static constexpr size_t step = pack<field_type<0>>::size;
+			static_assert(detail::all_true<(pack<Fields>::size == step)...>::value,
+						  "Pack-wise iteration requires fields with the same pack size");
+
+			pack_iterator(soa* s, size_t i) : s_{s}, i_{i} {}
+
+			value_type operator*() const { return s_->load_all(i_, indices{}); }
+			void store(value_type const& x) { s_->store_all(i_, x, indices{}); }
+
+			pack_iterator& operator++() { i_ += step; return *this; }
+			pack_iterator operator++(int) { auto old = *this; ++(*this); return old; }
+
+			bool operator==(pack_iterator const& rhs) const { return i_ == rhs.i_; }
+			bool operator!=(pack_iterator const& rhs) const { return i_ != rhs.i_; }
+
+			/**
+			 * \brief The element index of the first lane
+			 */
+			size_t index() const noexcept { return i_; }
+
+		private:
+			soa* s_;
+			size_t i_;
+		};
+
+		pack_iterator pack_begin() { return {this, 0}; }
+		pack_iterator pack_end() { return {this, padded_size()}; }
+
+	private:
+		std::tuple<column<Fields>...> columns_;
+		size_t size_{0};
+
+		static size_t round_up(size_t n) noexcept { return (n + padding - 1) / padding * padding; }
+
+		template <size_t... I>
+		void resize_columns(size_t n, detail::index_sequence<I...>) {
+			detail::expand({(std::get<I>(columns_).resize(n), 0)...});
+		}
+		template <size_t... I>
+		void reserve_columns(size_t n, detail::index_sequence<I...>) {
+			detail::expand({(std::get<I>(columns_).reserve(n), 0)...});
+		}
+		// Shrinking leaves old values in what is now padding
+		template <size_t... I>
+		void zero_columns(size_t first, detail::index_sequence<I...>) {
+			detail::expand({(std::fill(std::get<I>(columns_).begin() + static_cast<std::ptrdiff_t>(first),
+									   std::get<I>(columns_).end(), field_type<I>{0}), 0)...});
+		}
+		template <typename Tuple, size_t... I>
+		void set(size_t i, Tuple const& values, detail::index_sequence<I...>) {
+			detail::expand({(std::get<I>(columns_)[i] = std::get<I>(values), 0)...});
+		}
+		template <size_t... I>
+		std::tuple<Fields&...> element(size_t i, detail::index_sequence<I...>) {
+			return std::tuple<Fields&...>{std::get<I>(columns_)[i]...};
+		}
+		template <size_t... I>
+		std::tuple<pack<Fields>...> load_all(size_t i, detail::index_sequence<I...>) const {
+			return std::tuple<pack<Fields>...>{load<I>(i)...};
+		}
+		template <size_t... I>
+		void store_all(size_t i, std::tuple<pack<Fields>...> const& x, detail::index_sequence<I...>) {
+			detail::expand({(store<I>(i, std::get<I>(x)), 0)...});
+		}
+	};
+}}
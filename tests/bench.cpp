@@ -0,0 +1,1043 @@
+#include "scimd.hpp"
+#include "math.hpp"
+#include "multipack.hpp"
+#include "soa.hpp"
+#include "aosoa.hpp"
+#include "parallel.hpp"
+#include "expr.hpp"
+#include "indirect.hpp"
+#include "numa.hpp"
+#include "arena.hpp"
+#include "compress.hpp"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#if defined(__x86_64__) || defined(__i386__)
+#include <cpuid.h>
+#endif
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <string>
+#include <thread>
+#include <vector>
+
+/**
+ * 	Throughput benchmarks
+ *
+ * 	Each benchmark runs a kernel over arrays of `n` elements (default 4096,
+ * 	override with the first command-line argument) and reports the best
+ * 	time over several trials in nanoseconds per element. The throughput in
+ * 	GB/s counts the bytes each element reads and writes in the kernel, so
+ * 	it is only meaningful for the memory benchmarks and when `n` is large
+ * 	enough to spill out of cache.
+ *
+ * 	The results are written to stdout as JSON.
+ */
+
+#define SCIMD_STRINGIFY_(x) #x
+#define SCIMD_STRINGIFY(x) SCIMD_STRINGIFY_(x)
+
+/*
+ * 	glibc's vector math library (libmvec), called through its vector ABI
+ * 	names for the pack width of the target, to compare math.hpp against.
+ * 	The Makefile defines SCIMD_BENCH_NO_LIBMVEC (and drops -lmvec) with mvec=0.
+ */
+#if defined(__GLIBC__) && defined(__x86_64__) && !defined(SCIMD_BENCH_NO_LIBMVEC)
+	#if __GLIBC_PREREQ(2, 35)
+		#define SCIMD_MVEC_ATAN(isa, nf, nd, F, D) \
+			extern "C" F _ZGV##isa##N##nf##v_atanf(F); \
+			extern "C" D _ZGV##isa##N##nd##v_atan(D); \
+			namespace { \
+				inline F mvec_atan(F x) { return _ZGV##isa##N##nf##v_atanf(x); } \
+				inline D mvec_atan(D x) { return _ZGV##isa##N##nd##v_atan(x); } \
+			}
+		#define SCIMD_HAS_MVEC_ATAN
+	#else
+		#define SCIMD_MVEC_ATAN(isa, nf, nd, F, D)
+	#endif
+
+	#define SCIMD_MVEC_UNARY(fn, isa, nf, nd, F, D) \
+		extern "C" F _ZGV##isa##N##nf##v_##fn##f(F); \
+		extern "C" D _ZGV##isa##N##nd##v_##fn(D); \
+		namespace { \
+			inline F mvec_##fn(F x) { return _ZGV##isa##N##nf##v_##fn##f(x); } \
+			inline D mvec_##fn(D x) { return _ZGV##isa##N##nd##v_##fn(x); } \
+		}
+	#define SCIMD_MVEC(isa, nf, nd, F, D) \
+		SCIMD_MVEC_UNARY(exp, isa, nf, nd, F, D) \
+		SCIMD_MVEC_UNARY(log, isa, nf, nd, F, D) \
+		SCIMD_MVEC_UNARY(sin, isa, nf, nd, F, D) \
+		SCIMD_MVEC_ATAN(isa, nf, nd, F, D) \
+		extern "C" F _ZGV##isa##N##nf##vv_powf(F, F); \
+		extern "C" D _ZGV##isa##N##nd##vv_pow(D, D); \
+		namespace { \
+			inline F mvec_pow(F x, F y) { return _ZGV##isa##N##nf##vv_powf(x, y); } \
+			inline D mvec_pow(D x, D y) { return _ZGV##isa##N##nd##vv_pow(x, y); } \
+		}
+	#define SCIMD_HAS_MVEC
+
+	// The same selection as scimd.hpp
+	#if defined(__AVX512F__) && !defined(SCIMD_DISABLE_AVX512)
+		SCIMD_MVEC(e, 16, 8, __m512, __m512d)
+	#elif defined(__AVX__) && !defined(SCIMD_DISABLE_AVX) && defined(__AVX2__) && defined(__FMA__)
+		SCIMD_MVEC(d, 8, 4, __m256, __m256d)
+	#elif defined(__AVX__) && !defined(SCIMD_DISABLE_AVX)
+		SCIMD_MVEC(c, 8, 4, __m256, __m256d)
+	#elif defined(__SSE4_2__) && !defined(SCIMD_DISABLE_SSE)
+		SCIMD_MVEC(b, 4, 2, __m128, __m128d)
+	#else
+		#undef SCIMD_HAS_MVEC
+		#undef SCIMD_HAS_MVEC_ATAN
+	#endif
+#endif
+
+namespace {
+	template <typename T>
+	using buffer = std::vector<T, scimd::allocator<T, 64>>;
+
+	// Keep the compiler from optimizing away or hoisting the benchmarked work
+	inline void clobber() { __asm__ volatile("" : : : "memory"); }
+
+	template <typename T>
+	inline void escape(T const* p) { __asm__ volatile("" : : "g"(p) : "memory"); }
+
+	template <typename T> struct fp_name {};
+	template <> struct fp_name<float>  { static constexpr char const* value = "float"; };
+	template <> struct fp_name<double> { static constexpr char const* value = "double"; };
+
+	struct result {
+		std::string name;
+		char const* type;
+		double ns_per_element;
+		double bytes_per_element;
+	};
+	std::vector<result> results;
+
+	/*
+	 * 	Best time of a call to `f` in nanoseconds
+	 *
+	 * 	The repetition count is first doubled until a trial takes at least
+	 * 	10 ms so that timer resolution doesn't matter.
+	 */
+	template <typename F>
+	double best_ns(F&& f) {
+		using clock = std::chrono::steady_clock;
+		auto const trial = [&f](size_t reps) {
+			auto const start = clock::now();
+			for (size_t r = 0; r < reps; r++) {
+				f();
+				clobber();
+			}
+			return std::chrono::duration<double, std::nano>(clock::now() - start).count();
+		};
+
+		size_t reps = 1;
+		while (trial(reps) < 1e7) {
+			reps *= 2;
+		}
+		double best = std::numeric_limits<double>::max();
+		for (int i = 0; i < 5; i++) {
+			best = std::min(best, trial(reps) / static_cast<double>(reps));
+		}
+		return best;
+	}
+
+	template <typename T, typename F>
+	void run(std::string name, size_t n, double bytes_per_element, F&& f) {
+		double const ns = best_ns(f) / static_cast<double>(n);
+		results.push_back({std::move(name), fp_name<T>::value, ns, bytes_per_element});
+	}
+
+	template <typename T>
+	struct arrays {
+		buffer<T> x, y, z, out;
+		// The padding covers the misaligned copies
+		arrays(size_t n) : x(n + 16), y(n), z(n), out(n + 16) {
+			// Positive and well away from zero so every function is in its domain
+			for (size_t i = 0; i < n; i++) {
+				x[i] = static_cast<T>(1.0 + static_cast<double>(i % 97) / 97.0);
+				y[i] = static_cast<T>(1.0 + static_cast<double>(i % 89) / 89.0);
+				z[i] = static_cast<T>(1.0 + static_cast<double>(i % 83) / 83.0);
+			}
+		}
+	};
+
+	/*
+	 * 	out[i] = op(x[i], y[i]) over whole packs
+	 */
+	template <typename T, typename Op>
+	void run_binary(char const* name, arrays<T>& a, size_t n, Op op) {
+		using P = scimd::pack<T>;
+		run<T>(name, n, 3 * sizeof(T), [&a, n, op]() {
+			for (size_t i = 0; i < n; i += P::size) {
+				P x, y;
+				x.load(scimd::memory::aligned{}, &a.x[i]);
+				y.load(scimd::memory::aligned{}, &a.y[i]);
+				op(x, y).store(scimd::memory::aligned{}, &a.out[i]);
+			}
+		});
+	}
+
+	/*
+	 * 	out[i] = op(x[i]) over whole packs
+	 */
+	template <typename T, typename Op>
+	void run_unary(char const* name, arrays<T>& a, size_t n, Op op) {
+		using P = scimd::pack<T>;
+		run<T>(name, n, 2 * sizeof(T), [&a, n, op]() {
+			for (size_t i = 0; i < n; i += P::size) {
+				P x;
+				x.load(scimd::memory::aligned{}, &a.x[i]);
+				op(x).store(scimd::memory::aligned{}, &a.out[i]);
+			}
+		});
+	}
+
+	/*
+	 * 	run_unary with the same function from libm for comparison
+	 */
+	template <typename T, typename Op, typename Ref>
+	void run_math(char const* name, arrays<T>& a, size_t n, Op op, Ref ref) {
+		run_unary<T>(name, a, n, op);
+		run<T>(std::string{name} + "/libm", n, 2 * sizeof(T), [&a, n, ref]() {
+			for (size_t i = 0; i < n; i++) {
+				a.out[i] = ref(a.x[i]);
+			}
+		});
+	}
+
+	template <typename T>
+	void bench_operations(arrays<T>& a, size_t n) {
+		using P = scimd::pack<T>;
+		run_binary<T>("add", a, n, [](P x, P y) { return x + y; });
+		run_binary<T>("sub", a, n, [](P x, P y) { return x - y; });
+		run_binary<T>("mul", a, n, [](P x, P y) { return x * y; });
+		run_binary<T>("div", a, n, [](P x, P y) { return x / y; });
+		run_binary<T>("fma", a, n, [](P x, P y) { return fma(x, y, x); });
+		run_binary<T>("min", a, n, [](P x, P y) { return min(x, y); });
+		run_binary<T>("max", a, n, [](P x, P y) { return max(x, y); });
+		run_binary<T>("abs", a, n, [](P x, P y) { return abs(x - y); });
+		run_binary<T>("blend", a, n, [](P x, P y) { return x.blend(y, y < x); });
+		run_binary<T>("sqrt", a, n, [](P x, P) { return static_cast<P>(sqrt(x)); });
+		run_binary<T>("rsqrt", a, n, [](P x, P) { return ::rsqrt(x); });
+		run_binary<T>("rsqrt/fast", a, n, [](P x, P) { return ::rsqrt(x, scimd::precision::fast{}); });
+		run_binary<T>("rcp", a, n, [](P x, P) { return ::rcp(x); });
+		run_binary<T>("rcp/fast", a, n, [](P x, P) { return ::rcp(x, scimd::precision::fast{}); });
+		run_binary<T>("div_sqrt", a, n, [](P x, P y) { return y / static_cast<P>(sqrt(x)); });
+		run_binary<T>("reduce_add_pack", a, n, [](P x, P) { return P{reduce_add(x)}; });
+	}
+
+	template <typename T>
+	void bench_memory(arrays<T>& a, size_t n) {
+		using P = scimd::pack<T>;
+		constexpr size_t N = P::size;
+
+		run<T>("copy/aligned", n, 2 * sizeof(T), [&a, n]() {
+			for (size_t i = 0; i < n; i += N) {
+				P x;
+				x.load(scimd::memory::aligned{}, &a.x[i]);
+				x.store(scimd::memory::aligned{}, &a.out[i]);
+			}
+		});
+		// Off by one element, so every access is misaligned
+		run<T>("copy/unaligned", n, 2 * sizeof(T), [&a, n]() {
+			for (size_t i = 0; i < n; i += N) {
+				P x;
+				x.load(scimd::memory::unaligned{}, &a.x[i + 1]);
+				x.store(scimd::memory::unaligned{}, &a.out[i + 1]);
+			}
+		});
+		/*
+		 * 	The worst case for a 16-byte aligned buffer: with packs wider
+		 * 	than 16 bytes, every load and store at a 16-byte offset from a
+		 * 	cache line splits two lines (and with AVX-512, every one does).
+		 * 	The allocator now aligns for the pack, so this is avoidable.
+		 */
+		constexpr size_t split = 16 / sizeof(T);
+		run<T>("copy/split16", n, 2 * sizeof(T), [&a, n]() {
+			for (size_t i = 0; i < n; i += N) {
+				P x;
+				x.load(scimd::memory::unaligned{}, &a.x[i + split]);
+				x.store(scimd::memory::unaligned{}, &a.out[i + split]);
+			}
+		});
+		auto const sum = [](T const* p, size_t count) {
+			P s0{T{0}}, s1{s0}, s2{s0}, s3{s0}, x;
+			for (size_t i = 0; i < count; i += 4 * N) {
+				x.load(scimd::memory::unaligned{}, p + i);			s0 += x;
+				x.load(scimd::memory::unaligned{}, p + i + N);		s1 += x;
+				x.load(scimd::memory::unaligned{}, p + i + 2 * N);	s2 += x;
+				x.load(scimd::memory::unaligned{}, p + i + 3 * N);	s3 += x;
+			}
+			return (s0 + s1) + (s2 + s3);
+		};
+		run<T>("sum/aligned", n, sizeof(T), [&a, n, sum]() {
+			sum(&a.x[0], n - n % (4 * N)).store(&a.out[0]);
+		});
+		run<T>("sum/split16", n, sizeof(T), [&a, n, sum]() {
+			sum(&a.x[split], n - n % (4 * N)).store(&a.out[0]);
+		});
+
+		// In cache, where bypassing it only hurts
+		run<T>("copy/streaming", n, 2 * sizeof(T), [&a, n]() {
+			for (size_t i = 0; i < n; i += N) {
+				P x;
+				x.load(scimd::memory::aligned{}, &a.x[i]);
+				x.store(scimd::memory::streaming{}, &a.out[i]);
+			}
+			scimd::memory::sfence();
+		});
+		run<T>("copy/partial", n, 2 * sizeof(T), [&a, n]() {
+			for (size_t i = 0; i < n; i += N) {
+				P x;
+				x.load_n(&a.x[i], N - 1);
+				x.store_n(&a.out[i], N - 1);
+			}
+		});
+
+		// Loading one member of an array of structures
+		struct particle { T x, y, z; };
+		std::vector<particle> aos(n);
+		for (size_t i = 0; i < n; i++) {
+			aos[i] = {a.x[i], a.y[i], a.z[i]};
+		}
+		auto const get_y = [](particle const& p) { return p.y; };
+		run<T>("load/ragged", n, sizeof(T), [&a, &aos, n, get_y]() {
+			P sum;
+			for (size_t i = 0; i < n; i += N) {
+				P x;
+				x.load(scimd::memory::ragged{}, aos.begin() + static_cast<std::ptrdiff_t>(i), aos.end(), get_y, T{});
+				sum += x;
+			}
+			sum.store(&a.out[0]);
+		});
+		run<T>("load/compact", n, sizeof(T), [&a, &aos, n, get_y]() {
+			P sum;
+			for (size_t i = 0; i < n; i += N) {
+				P x;
+				x.load(scimd::memory::compact{}, aos.begin() + static_cast<std::ptrdiff_t>(i), aos.end(), get_y, T{});
+				sum += x;
+			}
+			sum.store(&a.out[0]);
+		});
+
+		// The same access through gather and scatter with a stride of three
+		std::vector<int32_t> stride(N);
+		for (size_t i = 0; i < N; i++) {
+			stride[i] = static_cast<int32_t>(3 * i);
+		}
+		scimd::index_pack<T> idx;
+		idx.load(stride.data());
+		T* members = &aos[0].x;
+		run<T>("gather", n, sizeof(T), [&a, members, idx, n]() {
+			P sum;
+			for (size_t i = 0; i < n; i += N) {
+				sum += gather(members + 3 * i + 1, idx);
+			}
+			sum.store(&a.out[0]);
+		});
+		run<T>("scatter", n, sizeof(T), [&a, members, idx, n]() {
+			for (size_t i = 0; i < n; i += N) {
+				P x;
+				x.load(scimd::memory::aligned{}, &a.x[i]);
+				scatter(members + 3 * i + 2, idx, x);
+			}
+			escape(members);
+		});
+	}
+
+	/*
+	 * 	A kernel behind an indirect call, to measure the cost of dispatch
+	 */
+	template <typename T>
+	__attribute__((noinline)) void scale(T const* x, T* y, size_t n) {
+		using P = scimd::pack<T>;
+		for (size_t i = 0; i < n; i += P::size) {
+			P v;
+			v.load(x + i);
+			(v * P{static_cast<T>(2.0)}).store(y + i);
+		}
+	}
+
+	template <typename T>
+	void bench_kernels(arrays<T>& a, size_t n) {
+		using P = scimd::pack<T>;
+		constexpr size_t N = P::size;
+
+		run<T>("axpy", n, 3 * sizeof(T), [&a, n]() {
+			P const alpha{static_cast<T>(0.5)};
+			for (size_t i = 0; i < n; i += N) {
+				P x, y;
+				x.load(scimd::memory::aligned{}, &a.x[i]);
+				y.load(scimd::memory::aligned{}, &a.y[i]);
+				fma(alpha, x, y).store(scimd::memory::aligned{}, &a.out[i]);
+			}
+		});
+
+		// The inverse distance from the origin of particles stored as SoA
+		run<T>("inverse_distance", n, 4 * sizeof(T), [&a, n]() {
+			for (size_t i = 0; i < n; i += N) {
+				P x, y, z;
+				x.load(scimd::memory::aligned{}, &a.x[i]);
+				y.load(scimd::memory::aligned{}, &a.y[i]);
+				z.load(scimd::memory::aligned{}, &a.z[i]);
+				::rsqrt(fma(x, x, fma(y, y, z * z))).store(scimd::memory::aligned{}, &a.out[i]);
+			}
+		});
+
+		run<T>("reduce_add", n, sizeof(T), [&a, n]() {
+			a.out[0] = scimd::reduce_add(a.x.data(), n);
+		});
+		run<T>("reduce_add/std::accumulate", n, sizeof(T), [&a, n]() {
+			a.out[0] = std::accumulate(a.x.begin(), a.x.begin() + static_cast<std::ptrdiff_t>(n), T{});
+		});
+		run<T>("reduce_max", n, sizeof(T), [&a, n]() {
+			a.out[0] = scimd::reduce_max(a.x.data(), n);
+		});
+		run<T>("reduce_max/std::max_element", n, sizeof(T), [&a, n]() {
+			a.out[0] = *std::max_element(a.x.begin(), a.x.begin() + static_cast<std::ptrdiff_t>(n));
+		});
+
+		// Small calls, where the overhead of the indirect call is most visible
+		constexpr size_t small = 16 * N;
+		auto const kernel = &scale<T>;
+		scimd::dispatch::function<void(T const*, T*, size_t)> const dispatched{
+			scimd::current_isa, kernel, kernel, kernel, kernel, kernel, kernel
+		};
+		run<T>("dispatch/direct", small, 2 * sizeof(T), [&a]() {
+			scale(a.x.data(), a.out.data(), small);
+		});
+		run<T>("dispatch/function", small, 2 * sizeof(T), [&a, &dispatched]() {
+			dispatched(a.x.data(), a.out.data(), small);
+		});
+	}
+
+	/*
+	 * 	A dot product with a single multipack<T, U> accumulator
+	 *
+	 * 	With U = 1, every fma waits on the previous one and the loop runs at
+	 * 	the fma latency. Each doubling of U should nearly halve the time until
+	 * 	the fma ports are saturated (U = latency * ports, e.g. 4 * 2 = 8 on
+	 * 	Skylake). Use `perf stat` for the instructions per cycle.
+	 */
+	template <typename T, size_t U>
+	void run_unrolled_dot(arrays<T>& a, size_t n) {
+		using M = scimd::multipack<T, U>;
+		run<T>("unroll/" + std::to_string(U) + "/dot", n, 2 * sizeof(T), [&a, n]() {
+			M acc{T{0}};
+			size_t i = 0;
+			for (; i + M::size <= n; i += M::size) {
+				M x, y;
+				x.load(scimd::memory::aligned{}, &a.x[i]);
+				y.load(scimd::memory::aligned{}, &a.y[i]);
+				acc = fma(x, y, acc);
+			}
+			T sum = reduce_add(acc);
+			for (; i < n; i++) {
+				sum += a.x[i] * a.y[i];
+			}
+			a.out[0] = sum;
+		});
+	}
+
+	template <typename T>
+	void bench_unroll(arrays<T>& a, size_t n) {
+		run_unrolled_dot<T, 1>(a, n);
+		run_unrolled_dot<T, 2>(a, n);
+		run_unrolled_dot<T, 4>(a, n);
+		run_unrolled_dot<T, 8>(a, n);
+	}
+
+	/*
+	 * 	out = x*y + sqrt(z) as an expression, as a hand-written pack loop,
+	 * 	and evaluated eagerly with a temporary array per operation
+	 *
+	 * 	The expression should match the hand-written loop; the eager version
+	 * 	makes three passes and writes two temporaries.
+	 */
+	template <typename T>
+	void bench_expressions(arrays<T>& a, size_t n) {
+		using P = scimd::pack<T>;
+		constexpr size_t N = P::size;
+		scimd::array_view<T> x{a.x.data(), n}, y{a.y.data(), n}, z{a.z.data(), n}, out{a.out.data(), n};
+
+		run<T>("expression/fused", n, 4 * sizeof(T), [&]() {
+			out = x * y + sqrt(z);
+		});
+		run<T>("expression/hand_written", n, 4 * sizeof(T), [&a, n]() {
+			for (size_t i = 0; i < n; i += N) {
+				P x, y, z;
+				x.load(scimd::memory::aligned{}, &a.x[i]);
+				y.load(scimd::memory::aligned{}, &a.y[i]);
+				z.load(scimd::memory::aligned{}, &a.z[i]);
+				fma(x, y, P{sqrt(z)}).store(scimd::memory::aligned{}, &a.out[i]);
+			}
+		});
+
+		buffer<T> product(n), root(n);
+		scimd::array_view<T> p{product}, r{root};
+		run<T>("expression/eager", n, 4 * sizeof(T), [&]() {
+			p = x * y;
+			r = sqrt(z);
+			out = p + r;
+		});
+	}
+
+	/*
+	 * 	All-pairs gravitational acceleration in three layouts
+	 *
+	 * 	The i-particles are broadcast and the j-particles are loaded a pack
+	 * 	at a time, so the layout determines how the j-loads are done: four
+	 * 	functor-based loads for AoS, four aligned loads from separate streams
+	 * 	for SoA, and four aligned loads from one tile for AoSoA. The padding
+	 * 	particles have zero mass, and a particle's force on itself is zero
+	 * 	because its separation is.
+	 *
+	 * 	The time is per interaction, with at most 1024 particles.
+	 */
+	template <typename T>
+	struct body { T x, y, z, m; };
+
+	template <typename T>
+	struct gravity_accumulator {
+		using P = scimd::pack<T>;
+		P ax, ay, az;
+		P const xi, yi, zi;
+		gravity_accumulator(body<T> const& b) : xi{b.x}, yi{b.y}, zi{b.z} {}
+
+		void operator()(P xj, P yj, P zj, P mj) {
+			P const softening{static_cast<T>(1e-3)};
+			P const dx = xj - xi, dy = yj - yi, dz = zj - zi;
+			P const inv = ::rsqrt(fma(dx, dx, fma(dy, dy, fma(dz, dz, softening))));
+			P const s = mj * inv * inv * inv;
+			ax = fma(s, dx, ax);
+			ay = fma(s, dy, ay);
+			az = fma(s, dz, az);
+		}
+		T sum() const { return reduce_add(ax) + reduce_add(ay) + reduce_add(az); }
+	};
+
+	template <typename T>
+	void bench_gravity(arrays<T>& a, size_t n) {
+		using P = scimd::pack<T>;
+		constexpr size_t N = P::size;
+		size_t const count = std::min<size_t>(n, 1024);
+
+		std::vector<body<T>> aos(count);
+		for (size_t i = 0; i < count; i++) {
+			aos[i] = {a.x[i], a.y[i], a.z[i], T{1}};
+		}
+		scimd::soa<T, T, T, T> soa(count);
+		for (size_t i = 0; i < count; i++) {
+			soa[i] = std::make_tuple(aos[i].x, aos[i].y, aos[i].z, aos[i].m);
+		}
+		scimd::aosoa<T, 4> aosoa;
+		aosoa.from_aos(&aos[0].x, count);
+
+		run<T>("gravity/aos", count * count, 4 * sizeof(T), [&a, &aos, count]() {
+			auto const end = aos.end();
+			for (size_t i = 0; i < count; i++) {
+				gravity_accumulator<T> acc{aos[i]};
+				for (size_t j = 0; j < count; j += N) {
+					auto const beg = aos.begin() + static_cast<std::ptrdiff_t>(j);
+					P xj, yj, zj, mj;
+					xj.load(beg, end, [](body<T> const& b) { return b.x; });
+					yj.load(beg, end, [](body<T> const& b) { return b.y; });
+					zj.load(beg, end, [](body<T> const& b) { return b.z; });
+					mj.load(beg, end, [](body<T> const& b) { return b.m; });
+					acc(xj, yj, zj, mj);
+				}
+				a.out[i] = acc.sum();
+			}
+		});
+		run<T>("gravity/soa", count * count, 4 * sizeof(T), [&a, &aos, &soa, count]() {
+			for (size_t i = 0; i < count; i++) {
+				gravity_accumulator<T> acc{aos[i]};
+				for (size_t j = 0; j < soa.padded_size(); j += N) {
+					acc(soa.template load<0>(j), soa.template load<1>(j), soa.template load<2>(j), soa.template load<3>(j));
+				}
+				a.out[i] = acc.sum();
+			}
+		});
+		run<T>("gravity/aosoa", count * count, 4 * sizeof(T), [&a, &aos, &aosoa, count]() {
+			for (size_t i = 0; i < count; i++) {
+				gravity_accumulator<T> acc{aos[i]};
+				for (size_t t = 0; t < aosoa.tiles(); t++) {
+					acc(aosoa.load(t, 0), aosoa.load(t, 1), aosoa.load(t, 2), aosoa.load(t, 3));
+				}
+				a.out[i] = acc.sum();
+			}
+		});
+	}
+
+	/*
+	 * 	Regular vs. streaming stores for outputs twice the size of the LLC
+	 *
+	 * 	A regular store first reads the line it writes (read for ownership),
+	 * 	so a copy moves three bytes for every two it needs and a fill moves
+	 * 	two for every one. The GB/s count only the needed bytes, so the
+	 * 	streaming versions should be up to 1.5x (copy) and 2x (fill) faster.
+	 * 	"auto" is scimd::copy on one thread, which should pick streaming.
+	 */
+	template <typename T>
+	void bench_streaming() {
+		using P = scimd::pack<T>;
+		constexpr size_t N = P::size;
+		size_t const count = 2 * scimd::memory::cache_size(3) / sizeof(T) / N * N;
+		buffer<T> x(count, T{1}), out(count);
+		scimd::thread_pool serial{1};
+
+		run<T>("streaming/copy/store", count, 2 * sizeof(T), [&x, &out, count]() {
+			for (size_t i = 0; i < count; i += N) {
+				P v;
+				v.load(scimd::memory::aligned{}, &x[i]);
+				v.store(scimd::memory::aligned{}, &out[i]);
+			}
+		});
+		run<T>("streaming/copy/stream", count, 2 * sizeof(T), [&x, &out, count]() {
+			for (size_t i = 0; i < count; i += N) {
+				P v;
+				v.load(scimd::memory::aligned{}, &x[i]);
+				v.store(scimd::memory::streaming{}, &out[i]);
+			}
+			scimd::memory::sfence();
+		});
+		run<T>("streaming/copy/auto", count, 2 * sizeof(T), [&x, &out, &serial, count]() {
+			scimd::copy(serial, x.data(), x.data() + count, out.data());
+		});
+		run<T>("streaming/fill/store", count, sizeof(T), [&out, count]() {
+			P v{T{2}};
+			for (size_t i = 0; i < count; i += N) {
+				v.store(scimd::memory::aligned{}, &out[i]);
+			}
+		});
+		run<T>("streaming/fill/stream", count, sizeof(T), [&out, count]() {
+			P v{T{2}};
+			for (size_t i = 0; i < count; i += N) {
+				v.store(scimd::memory::streaming{}, &out[i]);
+			}
+			scimd::memory::sfence();
+		});
+	}
+
+	/*
+	 * 	Prefetch distance for gathers through random indices
+	 *
+	 * 	The body does some math on each pack, as a neighbour-list kernel
+	 * 	would. The "llc" table is eight times the size of L2, so nearly every
+	 * 	lane misses L2; the "dram" table is twice the size of the LLC. The
+	 * 	best distance is where the time bottoms out; beyond it, prefetched
+	 * 	lines start to be evicted before they are used. When the misses are
+	 * 	dominated by TLB walks (e.g., in a VM), prefetching helps little.
+	 */
+	template <typename T>
+	void run_indirect(std::string const& name, size_t size) {
+		using P = scimd::pack<T>;
+		size_t const count = size_t{1} << 20;
+		buffer<T> table(size, T{1});
+		std::vector<int32_t> index(count);
+		uint64_t rng = 0x9e3779b97f4a7c15ull;
+		for (auto& i : index) {
+			rng ^= rng << 13;
+			rng ^= rng >> 7;
+			rng ^= rng << 17;
+			i = static_cast<int32_t>(rng % size);
+		}
+
+		buffer<T> out(P::size);
+		for (size_t distance : {0u, 1u, 2u, 4u, 8u, 16u, 32u, 64u}) {
+			run<T>(name + "/" + std::to_string(distance), count, sizeof(T), [&table, &index, &out, count, distance]() {
+				P sum{T{0}};
+				scimd::for_each_indirect(index.data(), count, distance, [&sum](size_t, P x) { sum += exp(P{sqrt(x)} * x); }, table.data());
+				sum.store(out.data());
+			});
+		}
+	}
+
+	template <typename T>
+	void bench_indirect() {
+		run_indirect<T>("indirect/llc", 8 * scimd::memory::cache_size(2) / sizeof(T));
+		run_indirect<T>("indirect/dram", 2 * scimd::memory::cache_size(3) / sizeof(T));
+	}
+
+	/*
+	 * 	TLB misses with standard and huge pages
+	 *
+	 * 	Both walks touch a 256 MiB table: "random" gathers from random
+	 * 	elements, and "pages" reads one element from each 4 KiB page in
+	 * 	turn, as a walk along the slow axis of a grid does. With 4 KiB pages
+	 * 	nearly every access needs a page walk; with 2 MiB pages the whole
+	 * 	table needs 128 TLB entries. How many huge pages were actually
+	 * 	obtained is printed to stderr.
+	 */
+	template <typename T, typename Alloc>
+	void run_tlb(std::string const& pages) {
+		using P = scimd::pack<T>;
+		constexpr size_t N = P::size;
+		size_t const size = (size_t{256} << 20) / sizeof(T);
+		size_t const count = size_t{1} << 20;
+		std::vector<T, Alloc> table(size, T{1});
+		std::fprintf(stderr, "tlb/%s/%s: %zu of %zu MiB on huge pages\n", pages.c_str(), fp_name<T>::value,
+					 scimd::memory::huge_page_bytes(table.data()) >> 20, (size * sizeof(T)) >> 20);
+
+		std::vector<int32_t> random(count), strided(count);
+		uint64_t rng = 0x9e3779b97f4a7c15ull;
+		size_t const stride = 4096 / sizeof(T) + 16;
+		for (size_t i = 0; i < count; i++) {
+			rng ^= rng << 13;
+			rng ^= rng >> 7;
+			rng ^= rng << 17;
+			random[i] = static_cast<int32_t>(rng % size);
+			strided[i] = static_cast<int32_t>((i * stride) % size);
+		}
+
+		buffer<T> out(N);
+		auto const walk = [&table, &out, count](std::vector<int32_t> const& index) {
+			P sum{T{0}};
+			scimd::for_each_indirect(index.data(), count, 0, [&sum](size_t, P x) { sum += x; }, table.data());
+			sum.store(out.data());
+		};
+		run<T>("tlb/random/" + pages, count, sizeof(T), [&walk, &random]() { walk(random); });
+		run<T>("tlb/pages/" + pages, count, sizeof(T), [&walk, &strided]() { walk(strided); });
+	}
+
+	template <typename T>
+	void bench_tlb() {
+		run_tlb<T, scimd::allocator<T>>("standard");
+		run_tlb<T, scimd::allocator<T, scimd::allocator<T>::alignment, scimd::memory::huge_pages>>("huge");
+	}
+
+	/*
+	 * 	Scaling of the parallel algorithms from one thread to all of them
+	 *
+	 * 	These use at least 4M elements so that every thread gets several
+	 * 	chunks. exp is compute-bound and should scale with the cores; the
+	 * 	sum of squares is bandwidth-bound once the array leaves the cache.
+	 */
+	template <typename T>
+	void bench_parallel(size_t n) {
+		using P = scimd::pack<T>;
+		size_t const count = std::max<size_t>(n, size_t{1} << 22);
+		buffer<T> x(count), out(count);
+		for (size_t i = 0; i < count; i++) {
+			x[i] = static_cast<T>(1.0 + static_cast<double>(i % 97) / 97.0);
+		}
+
+		std::vector<size_t> threads;
+		size_t const hardware = std::max<size_t>(1, std::thread::hardware_concurrency());
+		for (size_t t = 1; t < hardware; t *= 2) {
+			threads.push_back(t);
+		}
+		threads.push_back(hardware);
+
+		for (size_t t : threads) {
+			scimd::thread_pool pool{t};
+			std::string const suffix = "/" + std::to_string(t);
+			run<T>("parallel/transform/exp" + suffix, count, 2 * sizeof(T), [&pool, &x, &out, count]() {
+				scimd::transform(pool, x.data(), x.data() + count, out.data(), [](P v) { return exp(v); });
+			});
+			run<T>("parallel/transform_reduce/sum_squares" + suffix, count, sizeof(T), [&pool, &x, &out, count]() {
+				out[0] = scimd::transform_reduce(pool, x.data(), x.data() + count, T{0}, scimd::plus<T>{}, [](P v) { return v * v; });
+			});
+		}
+	}
+
+	/*
+	 * 	Bandwidth of a parallel sum with naive and first-touch placement
+	 *
+	 * 	Both loops sum the same partitions on the same pinned threads. The
+	 * 	"naive" array was zeroed by the main thread, so on a multi-socket
+	 * 	machine all of its pages are on one node; the "first_touch" array is
+	 * 	a partitioned_array. On a single node, the two should be the same.
+	 * 	The node of each partition is printed to stderr.
+	 */
+	template <typename T>
+	void bench_numa(size_t n) {
+		using P = scimd::pack<T>;
+		constexpr size_t N = P::size;
+		size_t const count = std::max<size_t>(n, size_t{1} << 24);
+		scimd::thread_pool pool;
+		scimd::partitioned_array<T> local{pool, count};
+		buffer<T> naive(count);
+		std::fprintf(stderr, "numa/%s: partitions on nodes", fp_name<T>::value);
+		for (auto const& part : local.partitions()) {
+			std::fprintf(stderr, " %d", part.node);
+		}
+		std::fprintf(stderr, "\n");
+
+		std::vector<T> partial(pool.size() * N);
+		auto const sum = [&local, &pool, &partial](T const* data) {
+			auto const& parts = local.partitions();
+			pool.broadcast([data, &parts, &partial](size_t t) {
+				P s{T{0}};
+				size_t i = parts[t].begin;
+				for (; i + N <= parts[t].end; i += N) {
+					P x;
+					x.load(scimd::memory::aligned{}, data + i);
+					s += x;
+				}
+				s.store(&partial[t * N]);
+			});
+		};
+		std::string const suffix = "/" + std::to_string(pool.size());
+		run<T>("numa/naive" + suffix, count, sizeof(T), [&sum, &naive]() { sum(naive.data()); });
+		run<T>("numa/first_touch" + suffix, count, sizeof(T), [&sum, &local]() { sum(local.data()); });
+	}
+
+	/*
+	 * 	Staging buffers from the heap vs. an arena
+	 *
+	 * 	Each call stands in for a timestep: it allocates two scratch arrays,
+	 * 	computes out = x * y + z through them, and frees them. "heap" uses
+	 * 	scimd::allocator for each buffer; "arena" takes them from the thread's
+	 * 	arena inside a scope. The difference is the cost of malloc and free
+	 * 	(and of first-touching fresh pages when the buffers are large).
+	 */
+	template <typename T>
+	void bench_arena(arrays<T>& a, size_t n) {
+		using P = scimd::pack<T>;
+		constexpr size_t N = P::size;
+		auto const kernel = [&a, n](T* xy, T* sum) {
+			for (size_t i = 0; i < n; i += N) {
+				P x, y;
+				x.load(scimd::memory::aligned{}, &a.x[i]);
+				y.load(scimd::memory::aligned{}, &a.y[i]);
+				(x * y).store(scimd::memory::aligned{}, xy + i);
+			}
+			for (size_t i = 0; i < n; i += N) {
+				P xy_i, z;
+				xy_i.load(scimd::memory::aligned{}, xy + i);
+				z.load(scimd::memory::aligned{}, &a.z[i]);
+				(xy_i + z).store(scimd::memory::aligned{}, sum + i);
+			}
+			std::copy(sum, sum + n, a.out.data());
+		};
+
+		run<T>("arena/heap", n, 4 * sizeof(T), [&kernel, n]() {
+			scimd::allocator<T> alloc;
+			T* xy = alloc.allocate(n);
+			T* sum = alloc.allocate(n);
+			kernel(xy, sum);
+			alloc.deallocate(sum, n);
+			alloc.deallocate(xy, n);
+		});
+		run<T>("arena/arena", n, 4 * sizeof(T), [&kernel, n]() {
+			auto& arena = scimd::thread_arena();
+			scimd::arena::scope s{arena};
+			kernel(arena.allocate<T>(n), arena.allocate<T>(n));
+		});
+	}
+
+	/*
+	 * 	Stream compaction: keep the elements of x below 1.5 (about half)
+	 *
+	 * 	"std" is std::copy_if, which branches on every element; "copy_if"
+	 * 	and "partition" compress whole packs (see compress.hpp).
+	 */
+	template <typename T>
+	void bench_compress(arrays<T>& a, size_t n) {
+		using P = scimd::pack<T>;
+		T const cut = static_cast<T>(1.5);
+		T* const x = a.x.data();
+		T* const out = a.out.data();
+		run<T>("compress/std", n, 2 * sizeof(T), [x, out, n, cut]() {
+			std::copy_if(x, x + n, out, [cut](T v) { return v < cut; });
+		});
+		run<T>("compress/copy_if", n, 2 * sizeof(T), [x, out, n, cut]() {
+			scimd::copy_if(x, x + n, out, [cut](P v) { return v < P{cut}; });
+		});
+		run<T>("compress/partition", n, 2 * sizeof(T), [&a, out, n, cut]() {
+			std::copy(a.y.data(), a.y.data() + n, out);
+			scimd::partition(out, out + n, [cut](P v) { return v < P{cut}; });
+		});
+	}
+
+	/*
+	 * 	out = (x < 1.5 && y > 1.2) ? x * y : 0, and the number of such elements
+	 *
+	 * 	"blends" combines the two conditions with blends and counts with a
+	 * 	reduction, as was necessary before conditional_t had operators; "algebra"
+	 * 	uses && and count().
+	 */
+	template <typename T>
+	void bench_masks(arrays<T>& a, size_t n) {
+		using P = scimd::pack<T>;
+		constexpr size_t N = P::size;
+		P const lo{static_cast<T>(1.5)}, hi{static_cast<T>(1.2)}, zero{T{0}}, one{T{1}};
+		size_t selected = 0;
+		escape(&selected);
+		run<T>("mask/blends", n, 3 * sizeof(T), [&]() {
+			P total{T{0}};
+			for (size_t i = 0; i < n; i += N) {
+				P x, y;
+				x.load(scimd::memory::aligned{}, &a.x[i]);
+				y.load(scimd::memory::aligned{}, &a.y[i]);
+				P both = zero;
+				both.blend(one, x < lo);
+				both = P{zero}.blend(both, y > hi);
+				P r = zero;
+				r.blend(x * y, both > zero);
+				r.store(scimd::memory::aligned{}, &a.out[i]);
+				total += both;
+			}
+			selected = static_cast<size_t>(reduce_add(total));
+		});
+		run<T>("mask/algebra", n, 3 * sizeof(T), [&]() {
+			size_t total = 0;
+			for (size_t i = 0; i < n; i += N) {
+				P x, y;
+				x.load(scimd::memory::aligned{}, &a.x[i]);
+				y.load(scimd::memory::aligned{}, &a.y[i]);
+				auto const both = (x < lo) && (y > hi);
+				P r = zero;
+				r.blend(x * y, both);
+				r.store(scimd::memory::aligned{}, &a.out[i]);
+				total += count(both);
+			}
+			selected = total;
+		});
+		escape(&selected);
+	}
+
+	/*
+	 * 	Static vs. work-stealing schedules for a loop of uneven cost
+	 *
+	 * 	The cost of an element grows linearly with its index (like particles
+	 * 	on ever shorter timesteps), so with a static schedule the last thread
+	 * 	has most of the work. "static" gives each thread one block, which is
+	 * 	what OpenMP's schedule(static) does; "stealing" hands the pool small
+	 * 	chunks and lets idle threads take them from the busy ones.
+	 */
+	template <typename T>
+	void bench_scheduler(size_t n) {
+		using P = scimd::pack<T>;
+		constexpr size_t N = P::size;
+		size_t const count = std::max<size_t>(n, size_t{1} << 16);
+		buffer<T> x(count), out(count);
+		for (size_t i = 0; i < count; i++) {
+			x[i] = static_cast<T>(1.0 + static_cast<double>(i % 97) / 97.0);
+		}
+		auto const kernel = [&x, &out, count](size_t begin, size_t end) {
+			for (size_t i = begin; i < end; i += N) {
+				P v;
+				v.load(scimd::memory::aligned{}, &x[i]);
+				size_t const steps = 1 + 64 * i / count;
+				for (size_t s = 0; s < steps; s++) {
+					v = fma(v, P{static_cast<T>(0.999)}, P{static_cast<T>(1e-3)});
+				}
+				v.store(scimd::memory::aligned{}, &out[i]);
+			}
+		};
+
+		size_t const hardware = std::max<size_t>(1, std::thread::hardware_concurrency());
+		scimd::thread_pool pool{hardware};
+		std::string const suffix = "/" + std::to_string(hardware);
+		run<T>("scheduler/static" + suffix, count, 2 * sizeof(T), [&pool, &kernel, count]() {
+			size_t const threads = pool.size();
+			pool.run(threads, [&kernel, count, threads](size_t t) {
+				size_t const block = (count / N + threads - 1) / threads * N;
+				kernel(std::min(count, t * block), std::min(count, (t + 1) * block));
+			});
+		});
+		run<T>("scheduler/stealing" + suffix, count, 2 * sizeof(T), [&pool, &kernel, count]() {
+			scimd::parallel_for<T>(pool, count, kernel, 64 * N);
+		});
+	}
+
+	template <typename T>
+	void bench_math(arrays<T>& a, size_t n) {
+		using P = scimd::pack<T>;
+		run_math<T>("exp", a, n, [](P x) { return exp(x); }, [](T x) { return std::exp(x); });
+		run_math<T>("log", a, n, [](P x) { return log(x); }, [](T x) { return std::log(x); });
+		run_math<T>("pow", a, n, [](P x) { return pow(x, P{static_cast<T>(1.7)}); }, [](T x) { return std::pow(x, static_cast<T>(1.7)); });
+		run_math<T>("sin", a, n, [](P x) { return sin(x); }, [](T x) { return std::sin(x); });
+		run_unary<T>("sin/limited", a, n, [](P x) { return sin(x, scimd::range::limited{}); });
+		run_math<T>("atan", a, n, [](P x) { return atan(x); }, [](T x) { return std::atan(x); });
+#ifdef SCIMD_HAS_MVEC
+		run_unary<T>("exp/libmvec", a, n, [](P x) { return P{mvec_exp(x.val)}; });
+		run_unary<T>("log/libmvec", a, n, [](P x) { return P{mvec_log(x.val)}; });
+		run_unary<T>("pow/libmvec", a, n, [](P x) { return P{mvec_pow(x.val, P{static_cast<T>(1.7)}.val)}; });
+		run_unary<T>("sin/libmvec", a, n, [](P x) { return P{mvec_sin(x.val)}; });
+#endif
+#ifdef SCIMD_HAS_MVEC_ATAN
+		run_unary<T>("atan/libmvec", a, n, [](P x) { return P{mvec_atan(x.val)}; });
+#endif
+	}
+
+	template <typename T>
+	void bench_all(size_t n) {
+		arrays<T> a(n);
+		bench_operations(a, n);
+		bench_memory(a, n);
+		bench_kernels(a, n);
+		bench_unroll(a, n);
+		bench_expressions(a, n);
+		bench_gravity(a, n);
+		bench_math(a, n);
+		bench_streaming<T>();
+		bench_indirect<T>();
+		bench_tlb<T>();
+		bench_parallel<T>(n);
+		bench_scheduler<T>(n);
+		bench_numa<T>(n);
+		bench_arena(a, n);
+		bench_compress(a, n);
+		bench_masks(a, n);
+	}
+
+	std::string cpu_name() {
+#if defined(__x86_64__) || defined(__i386__)
+		unsigned int regs[12];
+		if (__get_cpuid_max(0x80000000, nullptr) < 0x80000004) {
+			return "unknown";
+		}
+		for (unsigned int i = 0; i < 3; i++) {
+			__get_cpuid(0x80000002 + i, &regs[4 * i], &regs[4 * i + 1], &regs[4 * i + 2], &regs[4 * i + 3]);
+		}
+		char brand[sizeof(regs) + 1] = {};
+		std::memcpy(brand, regs, sizeof(regs));
+		std::string name{brand};
+		name.erase(0, name.find_first_not_of(' '));
+		return name;
+#else
+		return "unknown";
+#endif
+	}
+
+	std::string json_escape(std::string const& s) {
+		std::string out;
+		for (char c : s) {
+			if (c == '"' || c == '\\') {
+				out += '\\';
+			}
+			out += c;
+		}
+		return out;
+	}
+}
+
+int main(int argc, char** argv) {
+	// A multiple of 16 keeps every pack width and the 64-byte allocation happy
+	size_t n = (argc > 1) ? std::strtoul(argv[1], nullptr, 10) : 4096;
+	n = std::max<size_t>(16, n - n % 16);
+
+	bench_all<float>(n);
+	bench_all<double>(n);
+
+	std::printf("{\n");
+	std::printf("  \"isa\": \"%s\",\n", SCIMD_STRINGIFY(SCIMD_ISA));
+	std::printf("  \"cpu\": \"%s\",\n", json_escape(cpu_name()).c_str());
+	std::printf("  \"compiler\": \"%s\",\n", json_escape(__VERSION__).c_str());
+	std::printf("  \"elements\": %zu,\n", n);
+	std::printf("  \"results\": [\n");
+	for (size_t i = 0; i < results.size(); i++) {
+		auto const& r = results[i];
+		std::printf("    {\"name\": \"%s\", \"type\": \"%s\", \"ns_per_element\": %.4f, \"gb_per_s\": %.3f}%s\n",
+					r.name.c_str(), r.type, r.ns_per_element, r.bytes_per_element / r.ns_per_element,
+					(i + 1 < results.size()) ? "," : "");
+	}
+	std::printf("  ]\n}\n");
+}
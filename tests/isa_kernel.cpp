@@ -0,0 +1,15 @@
+#include "scimd.hpp"
+
+/*
+ * 	The test links this kernel compiled for two instruction sets (see the
+ * 	isa_*.o rules in the Makefile) into one binary. Each copy lives in its
+ * 	own ISA namespace, so neither the kernel nor the scimd functions it
+ * 	inlines may collide.
+ */
+namespace scimd { namespace SCIMD_ISA_NAMESPACE {
+	// The sum of x[0, n) and, counted with a reduction, the lanes in a pack
+	size_t isa_kernel(float const* x, size_t n, float& sum) {
+		sum = reduce_add(x, n);
+		return static_cast<size_t>(::reduce_add(pack<float>{1.0f}));
+	}
+}}
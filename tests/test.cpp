@@ -1,11 +1,29 @@
 #include "catch2.hpp"
 #include "scimd.hpp"
+#include "math.hpp"
+#include "multipack.hpp"
+#include "soa.hpp"
+#include "aosoa.hpp"
+#include "parallel.hpp"
+#include "expr.hpp"
+#include "indirect.hpp"
+#include "numa.hpp"
+#include "arena.hpp"
+#include "compress.hpp"
 #include <cmath>
 #include <cstdlib>
 #include <string>
 #include <numeric>
 #include <array>
 #include <algorithm>
+#include <limits>
+#include <atomic>
+#include <chrono>
+#include <iterator>
+#include <list>
+#include <stdexcept>
+#include <thread>
+#include <vector>
 
 // These will eventually be replaced by versions from the standard library
 bool all(bool x) { return x; }
@@ -76,6 +94,13 @@ void test_memory() {
 		REQUIRE(x.load(scimd::memory::unaligned{}, input.data()) == (std::begin(input) + N));
 		REQUIRE(x.store(scimd::memory::unaligned{}, out.data()) == std::end(out));
 		REQUIRE(is_same(input, out));
+
+		// aligned load, streaming store
+		out.fill(T{-1});
+		REQUIRE(x.load(scimd::memory::aligned{}, input.data()) == (std::begin(input) + N));
+		REQUIRE(x.store(scimd::memory::streaming{}, out.data()) == std::end(out));
+		scimd::memory::sfence();
+		REQUIRE(is_same(input, out));
 	}
 
 	SECTION("load/store for T = " + std::string{fp_name<T>::value}) {
@@ -102,6 +127,101 @@ void test_memory() {
 		REQUIRE(is_same(out_lambda, out_plain));
 	}
 
+	SECTION("partial load/store for T = " + std::string{fp_name<T>::value}) {
+		for (size_t n = 0; n <= N; n++) {
+			scimd::pack<T> x;
+			REQUIRE(x.load_n(input.data(), n) == input.data() + n);
+
+			// Lanes past n are zero
+			alignas(scimd::pack<T>) std::array<T, N> loaded;
+			x.store(loaded.data());
+			for (size_t i = 0; i < N; i++) {
+				REQUIRE(loaded[i] == ((i < n) ? input[i] : T{}));
+			}
+
+			// Memory past n is not written
+			std::array<T, N> out;
+			out.fill(T{-1});
+			REQUIRE(x.store_n(out.data(), n) == out.data() + n);
+			for (size_t i = 0; i < N; i++) {
+				REQUIRE(out[i] == ((i < n) ? input[i] : T{-1}));
+			}
+		}
+	}
+
+	SECTION("allocator for T = " + std::string{fp_name<T>::value}) {
+		using alloc = scimd::allocator<T>;
+		REQUIRE(alloc::alignment == sizeof(typename scimd::pack<T>::simd_t));
+
+		// A single element is padded to a whole pack, which can be loaded and stored aligned
+		std::vector<T, alloc> v(1, T{3});
+		REQUIRE(reinterpret_cast<uintptr_t>(v.data()) % alloc::alignment == 0);
+		REQUIRE(malloc_usable_size(v.data()) >= sizeof(scimd::pack<T>));
+		scimd::pack<T> x;
+		x.load(scimd::memory::aligned{}, v.data());
+		(x + T{1}).store(scimd::memory::aligned{}, v.data());
+		REQUIRE(v[0] == T{4});
+
+		// Explicit alignments still apply, rounded up to the pack
+		scimd::allocator<T, 128> wide;
+		T* p = wide.allocate(3);
+		REQUIRE(reinterpret_cast<uintptr_t>(p) % 128 == 0);
+		wide.deallocate(p, 3);
+	}
+
+	SECTION("allocator moves for T = " + std::string{fp_name<T>::value}) {
+		using alloc = scimd::allocator<T>;
+		using traits = std::allocator_traits<alloc>;
+		static_assert(std::is_same<typename traits::template rebind_alloc<int>, scimd::allocator<int, alloc::alignment>>::value, "rebind keeps the alignment");
+		static_assert(traits::propagate_on_container_move_assignment::value, "move assignment takes the buffer");
+		static_assert(alloc::is_always_equal::value, "the allocator is stateless");
+		REQUIRE(alloc{} == scimd::allocator<int, 128>{});
+		REQUIRE_FALSE(alloc{} != alloc{});
+
+		// Moves and swaps take the buffer instead of allocating a new one
+		std::vector<T, alloc> a(1000, T{1}), b(10, T{2});
+		T const* const pa = a.data();
+		std::vector<T, alloc> c{std::move(a)};
+		REQUIRE(c.data() == pa);
+		b = std::move(c);
+		REQUIRE(b.data() == pa);
+		REQUIRE(b.size() == 1000);
+		std::vector<T, alloc> d(10, T{2});
+		T const* const pd = d.data();
+		b.swap(d);
+		REQUIRE(b.data() == pd);
+		REQUIRE(d.data() == pa);
+
+		// Node-based containers allocate through rebind
+		std::list<T, alloc> l{T{1}, T{2}, T{3}};
+		REQUIRE(std::accumulate(l.begin(), l.end(), T{0}) == T{6});
+	}
+
+	SECTION("huge page allocator for T = " + std::string{fp_name<T>::value}) {
+		using huge = scimd::allocator<T, scimd::allocator<T>::alignment, scimd::memory::huge_pages>;
+		constexpr size_t page = scimd::memory::huge_pages::page_size;
+		REQUIRE(huge{} != scimd::allocator<T>{});
+		REQUIRE(huge{} == typename huge::template rebind<int>::other{});
+
+		// Large allocations are mapped on 2 MiB boundaries
+		size_t const n = (page + page / 2) / sizeof(T);
+		std::vector<T, huge> v(n, T{1});
+		REQUIRE(reinterpret_cast<uintptr_t>(v.data()) % page == 0);
+		REQUIRE(std::accumulate(v.begin(), v.end(), T{0}) == static_cast<T>(n));
+
+		// Whether huge pages were obtained depends on the system, but never more than the mapping
+		size_t const obtained = scimd::memory::huge_page_bytes(v.data());
+		REQUIRE(obtained <= 2 * page);
+		if (obtained == 0) {
+			WARN("No huge pages were obtained for T = " << fp_name<T>::value);
+		}
+
+		// Small allocations use the standard pages
+		std::vector<T, huge> small(16, T{2});
+		REQUIRE(reinterpret_cast<uintptr_t>(small.data()) % huge::alignment == 0);
+		REQUIRE(small[15] == T{2});
+	}
+
 	SECTION("load/store with default for T = " + std::string{fp_name<T>::value}) {
 		// use lambda load of 1 value and fill the rest of the SIMD vector
 		// with the default value
@@ -199,6 +319,13 @@ void test_operators() {
 		REQUIRE(all(((scimd::pack<T>{y} /= x) - (y / x)) <= tol));
 	}
 
+	SECTION("fused multiply-add for T = " + std::string{fp_name<T>::value}) {
+		REQUIRE(all((fma(x, y, x) - (x * y + x)) <= tol));
+		REQUIRE(all((fms(x, y, x) - (x * y - x)) <= tol));
+		REQUIRE(all((fnma(x, y, x) - (x - x * y)) <= tol));
+		REQUIRE(all((fnms(x, y, x) - (-(x * y) - x)) <= tol));
+	}
+
 	SECTION("logical operators for T = " + std::string{fp_name<T>::value}) {
 		REQUIRE(all(y > x));
 		REQUIRE(none(y < x));
@@ -222,6 +349,1168 @@ void test_operators() {
 	}
 }
 
+template <typename T>
+void test_reductions() {
+	constexpr auto N = scimd::pack<T>::size;
+
+	SECTION("pack reductions for T = " + std::string{fp_name<T>::value}) {
+		alignas(scimd::pack<T>) std::array<T, N> input;
+		std::iota(std::begin(input), std::end(input), T{1});
+		scimd::pack<T> x;
+		x.load(input.data());
+
+		REQUIRE(reduce_add(x) == std::accumulate(std::begin(input), std::end(input), T{0}));
+		REQUIRE(reduce_mul(scimd::pack<T>{T{2}}) == std::ldexp(T{1}, static_cast<int>(N)));
+		REQUIRE(reduce_min(x) == T{1});
+		REQUIRE(reduce_max(x) == static_cast<T>(N));
+	}
+
+	SECTION("array reductions for T = " + std::string{fp_name<T>::value}) {
+		// Cover the unrolled loop, the single-pack loop, and the scalar tail
+		std::array<T, 4 * N * 2 + N + 3> input;
+		std::iota(std::begin(input), std::end(input), T{1});
+		std::reverse(std::begin(input), std::begin(input) + 5);
+		auto const n = input.size();
+
+		REQUIRE(scimd::reduce_add(input.data(), n) == std::accumulate(std::begin(input), std::end(input), T{0}));
+		REQUIRE(scimd::reduce_min(input.data(), n) == T{1});
+		REQUIRE(scimd::reduce_max(input.data(), n) == static_cast<T>(n));
+
+		std::array<T, 4 * N + 1> twos;
+		twos.fill(T{2});
+		REQUIRE(scimd::reduce_mul(twos.data(), twos.size()) == std::ldexp(T{1}, static_cast<int>(twos.size())));
+
+		REQUIRE(scimd::reduce_add(input.data(), 0) == T{0});
+		REQUIRE(scimd::reduce_mul(input.data(), 0) == T{1});
+	}
+}
+
+template <typename T, typename I = int32_t>
+void test_gather_scatter() {
+	constexpr auto N = scimd::pack<T>::size;
+	std::string const name = std::string{fp_name<T>::value} + (sizeof(I) == 8 ? " with int64_t indices" : "");
+
+	// An array of structures {x, y, z}
+	std::array<T, 3 * N> aos;
+	std::iota(std::begin(aos), std::end(aos), T{0});
+
+	// Visit the structures in reverse order
+	std::array<I, N> indices;
+	for (size_t i = 0; i < N; i++) {
+		indices[i] = static_cast<I>(3 * (N - 1 - i));
+	}
+	scimd::index_pack<T, I> idx;
+	REQUIRE(idx.load(indices.data()) == indices.data() + N);
+
+	std::array<I, N> idx_out;
+	idx.store(idx_out.data());
+	REQUIRE(idx_out == indices);
+
+	SECTION("gather for T = " + name) {
+		// Gather the 'y' members
+		auto y = gather(aos.data() + 1, idx);
+		alignas(scimd::pack<T>) std::array<T, N> out;
+		y.store(out.data());
+		for (size_t i = 0; i < N; i++) {
+			REQUIRE(out[i] == aos[static_cast<size_t>(indices[i]) + 1]);
+		}
+	}
+
+	SECTION("scatter for T = " + name) {
+		alignas(scimd::pack<T>) std::array<T, N> in;
+		std::iota(std::begin(in), std::end(in), T{1});
+		scimd::pack<T> x;
+		x.load(in.data());
+
+		// Scatter into the 'z' members
+		std::array<T, 3 * N> out;
+		out.fill(T{});
+		scatter(out.data() + 2, idx, x);
+		for (size_t i = 0; i < N; i++) {
+			REQUIRE(out[static_cast<size_t>(indices[i]) + 2] == in[i]);
+			REQUIRE(out[static_cast<size_t>(indices[i])] == T{});
+		}
+	}
+	if (sizeof(I) == 8) {
+		SECTION("gather and scatter past 2^31 elements for T = " + name) {
+			// Reserve 2^35 elements without backing them; only the touched pages are allocated.
+			// None of the indices fits in an int32_t.
+			size_t const bytes = (size_t{1} << 35) * sizeof(T);
+			void* const p = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+			if (p == MAP_FAILED) {
+				WARN("Could not reserve the address space");
+				return;
+			}
+			T* const base = static_cast<T*>(p);
+			std::array<I, N> far;
+			for (size_t i = 0; i < N; i++) {
+				far[i] = static_cast<I>((uint64_t{1} << 31) * (i + 1) + i);
+				base[far[i]] = static_cast<T>(i + 1);
+			}
+			scimd::index_pack<T, I> fidx;
+			fidx.load(far.data());
+			alignas(scimd::pack<T>) std::array<T, N> out;
+			gather(static_cast<T const*>(base), fidx).store(out.data());
+			for (size_t i = 0; i < N; i++) {
+				REQUIRE(out[i] == static_cast<T>(i + 1));
+			}
+			scatter(base, fidx, gather(static_cast<T const*>(base), fidx) * T{2});
+			for (size_t i = 0; i < N; i++) {
+				REQUIRE(base[far[i]] == static_cast<T>(2 * (i + 1)));
+			}
+			munmap(p, bytes);
+		}
+	}
+}
+
+// Compare `vec` against `ref` on 64 packs spread over [lo, hi]
+template <typename T, typename F, typename G, typename C>
+void check_grid(F vec, G ref, T lo, T hi, C close) {
+	constexpr auto N = scimd::pack<T>::size;
+
+	for (size_t k = 0; k < 64; k++) {
+		alignas(scimd::pack<T>) std::array<T, N> in, out;
+		for (size_t i = 0; i < N; i++) {
+			in[i] = lo + (hi - lo) * static_cast<T>(k * N + i) / static_cast<T>(64 * N - 1);
+		}
+		scimd::pack<T> x;
+		x.load(in.data());
+		vec(x).store(out.data());
+		for (size_t i = 0; i < N; i++) {
+			T const expected = ref(in[i]);
+			INFO("x = " << in[i] << ", expected " << expected << ", got " << out[i]);
+			REQUIRE(close(out[i], expected));
+		}
+	}
+}
+
+template <typename T, typename F, typename G>
+void check_math(F vec, G ref, T lo, T hi, T tol = 8 * std::numeric_limits<T>::epsilon()) {
+	// A relative tolerance, for the precision tests; the math functions use check_ulps
+	check_grid<T>(vec, ref, lo, hi, [tol](T out, T expected) { return std::abs(out - expected) <= tol * std::abs(expected); });
+}
+
+// The error of `out` in units of the last place of `expected`
+template <typename T>
+T ulp_error(T out, T expected) {
+	T const a = std::abs(expected);
+	return std::abs(out - expected) / (std::nextafter(a, std::numeric_limits<T>::infinity()) - a);
+}
+
+// Check against the error bounds documented in math.hpp. The reference
+// is the libm result rounded to T, which the bounds already cover on
+// the test points.
+template <typename T, typename F, typename G>
+void check_ulps(F vec, G ref, T lo, T hi, T ulps) {
+	check_grid<T>(vec, ref, lo, hi, [ulps](T out, T expected) { return ulp_error(out, expected) <= ulps; });
+}
+
+template <typename T>
+void check_math_special(scimd::pack<T> x, T expected) {
+	alignas(scimd::pack<T>) std::array<T, scimd::pack<T>::size> out;
+	x.store(out.data());
+	for (auto v : out) {
+		if (std::isnan(expected)) {
+			REQUIRE(std::isnan(v));
+		} else {
+			REQUIRE(v == expected);
+		}
+	}
+}
+
+template <typename T>
+void test_math() {
+	using P = scimd::pack<T>;
+	T const inf = std::numeric_limits<T>::infinity();
+
+	SECTION("exponentials for T = " + std::string{fp_name<T>::value}) {
+		check_ulps<T>([](P x) { return exp(x); }, [](T x) { return std::exp(x); }, T{-80}, T{80}, T{1});
+		check_ulps<T>([](P x) { return exp2(x); }, [](T x) { return std::exp2(x); }, T{-120}, T{120}, T{1});
+		check_ulps<T>([](P x) { return expm1(x); }, [](T x) { return std::expm1(x); }, T{-2}, T{2}, T{2});
+	}
+
+	SECTION("logarithms for T = " + std::string{fp_name<T>::value}) {
+		check_ulps<T>([](P x) { return log(x); }, [](T x) { return std::log(x); }, T{1e-3}, T{1e3}, T{1});
+		check_ulps<T>([](P x) { return log2(x); }, [](T x) { return std::log2(x); }, T{1e-3}, T{1e3}, T{1.5});
+		check_ulps<T>([](P x) { return log1p(x); }, [](T x) { return std::log1p(x); }, T{-0.9}, T{10}, T{1.5});
+	}
+
+	SECTION("pow for T = " + std::string{fp_name<T>::value}) {
+		T const ulps = T{1.5};
+		check_ulps<T>([](P x) { return pow(x, P{T{2.5}}); }, [](T x) { return std::pow(x, T{2.5}); }, T{1e-2}, T{1e2}, ulps);
+		check_ulps<T>([](P x) { return pow(P{T{1.5}}, x); }, [](T x) { return std::pow(T{1.5}, x); }, T{-50}, T{50}, ulps);
+		check_ulps<T>([](P x) { return pow(-x, T{3}); }, [](T x) { return std::pow(-x, T{3}); }, T{1e-2}, T{1e2}, ulps);
+
+		// Large |y*log2(x)|, where the error of log2(x) is multiplied by y
+		bool const single = sizeof(T) == 4;
+		check_ulps<T>([](P y) { return pow(P{T{1.5}}, y); }, [](T y) { return std::pow(T{1.5}, y); },
+			single ? T{150} : T{1500}, single ? T{218} : T{1750}, ulps);
+		check_ulps<T>([](P y) { return pow(P{T{0.9}}, y); }, [](T y) { return std::pow(T{0.9}, y); },
+			single ? T{500} : T{5000}, single ? T{820} : T{6700}, ulps);
+		check_ulps<T>([](P x) { return pow(x, T{1e5}); }, [](T x) { return std::pow(x, T{1e5}); },
+			single ? T{0.9995} : T{0.995}, single ? T{1.0005} : T{1.005}, ulps);
+		check_ulps<T>([](P x) { return pow(x, T{-300}); }, [](T x) { return std::pow(x, T{-300}); },
+			T{0.75}, single ? T{1.34} : T{1.41}, ulps);
+		check_ulps<T>([](P y) { return pow(P{T{1.5}}, y); }, [](T y) { return std::pow(T{1.5}, y); },
+			T{199.996337890625}, T{199.996337890625}, ulps);
+		check_ulps<T>([](P y) { return pow(P{T{0.9}}, y); }, [](T y) { return std::pow(T{0.9}, y); },
+			single ? T{800} : T{6658}, single ? T{800} : T{6658}, ulps);
+	}
+
+	SECTION("trigonometric functions for T = " + std::string{fp_name<T>::value}) {
+		bool const single = sizeof(T) == 4;
+		check_ulps<T>([](P x) { return sin(x); }, [](T x) { return std::sin(x); }, T{-10}, T{10}, T{2.5});
+		check_ulps<T>([](P x) { return cos(x); }, [](T x) { return std::cos(x); }, T{-10}, T{10}, T{2.5});
+		check_ulps<T>([](P x) { return tan(x); }, [](T x) { return std::tan(x); }, T{-1.5}, T{1.5}, single ? T{3.5} : T{3});
+		check_ulps<T>([](P x) { return sin(x, scimd::range::limited{}); }, [](T x) { return std::sin(x); }, T{-1000}, T{1000}, T{2.5});
+		// Each square doubles the error of sin or cos, and the sum rounds once more
+		check_ulps<T>([](P x) { P s, c; sincos(x, s, c); return s * s + c * c; }, [](T) { return T{1}; }, T{-10}, T{10}, T{6});
+		check_ulps<T>([](P x) { return asin(x); }, [](T x) { return std::asin(x); }, T{-1}, T{1}, T{2.5});
+		check_ulps<T>([](P x) { return acos(x); }, [](T x) { return std::acos(x); }, T{-1}, T{1}, T{1.5});
+		check_ulps<T>([](P x) { return atan(x); }, [](T x) { return std::atan(x); }, T{-10}, T{10}, single ? T{2.5} : T{1});
+		check_ulps<T>([](P x) { return atan2(x, P{T{-2}}); }, [](T x) { return std::atan2(x, T{-2}); }, T{-10}, T{10}, single ? T{3} : T{1.5});
+	}
+
+	SECTION("trigonometric range reduction for T = " + std::string{fp_name<T>::value}) {
+		// Beyond the Cody-Waite limit, including the largest finite value
+		check_ulps<T>([](P x) { return sin(x); }, [](T x) { return std::sin(x); }, T{1e4}, T{1e7}, T{2.5});
+		check_ulps<T>([](P x) { return cos(x); }, [](T x) { return std::cos(x); }, T{-1e7}, T{-1e4}, T{2.5});
+		T const big = std::numeric_limits<T>::max();
+		check_ulps<T>([](P x) { return sin(x); }, [](T x) { return std::sin(x); }, big, big, T{2.5});
+		check_ulps<T>([](P x) { return cos(x); }, [](T x) { return std::cos(x); }, big, big, T{2.5});
+	}
+
+	SECTION("special values for T = " + std::string{fp_name<T>::value}) {
+		check_math_special(exp(P{inf}), inf);
+		check_math_special(exp(P{-inf}), T{0});
+		check_math_special(exp(P{T{1000}}), inf);
+		check_math_special(log(P{T{0}}), -inf);
+		check_math_special(log(P{inf}), inf);
+		check_math_special(log(P{T{-1}}), std::numeric_limits<T>::quiet_NaN());
+		check_math_special(log1p(P{T{-1}}), -inf);
+		check_math_special(pow(P{T{-2}}, P{T{0.5}}), std::numeric_limits<T>::quiet_NaN());
+		check_math_special(pow(P{T{-1}}, P{inf}), T{1});
+		check_math_special(pow(P{std::numeric_limits<T>::quiet_NaN()}, P{T{0}}), T{1});
+		check_math_special(pow(P{T{0}}, P{T{-1}}), inf);
+		check_math_special(sin(P{inf}), std::numeric_limits<T>::quiet_NaN());
+		check_math_special(asin(P{T{2}}), std::numeric_limits<T>::quiet_NaN());
+		check_math_special(atan2(P{T{0}}, P{T{0}}), T{0});
+		check_math_special(atan2(P{inf}, P{inf}), std::atan2(inf, inf));
+	}
+}
+
+template <typename T>
+void test_precision() {
+	using P = scimd::pack<T>;
+	using scimd::precision::fast;
+	using scimd::precision::standard;
+	using scimd::precision::exact;
+
+	// The worst hardware estimate is 1.5*2^-12 (SSE and AVX)
+	T const fast_tol = T{4e-4};
+	T const lo = T{1e-3}, hi = T{1e3};
+	auto const rsqrt_ref = [](T x) { return T{1} / std::sqrt(x); };
+	auto const rcp_ref = [](T x) { return T{1} / x; };
+	auto const div_ref = [](T x) { return T{3} / x; };
+
+	SECTION("rsqrt for T = " + std::string{fp_name<T>::value}) {
+		check_math<T>([](P x) { return rsqrt(x, fast{}); }, rsqrt_ref, lo, hi, fast_tol);
+		check_math<T>([](P x) { return rsqrt(x, standard{}); }, rsqrt_ref, lo, hi);
+		check_math<T>([](P x) { return rsqrt(x, exact{}); }, rsqrt_ref, lo, hi, T{0});
+	}
+
+	SECTION("rcp for T = " + std::string{fp_name<T>::value}) {
+		check_math<T>([](P x) { return rcp(x, fast{}); }, rcp_ref, lo, hi, fast_tol);
+		check_math<T>([](P x) { return rcp(x); }, rcp_ref, lo, hi);
+		check_math<T>([](P x) { return rcp(x, standard{}); }, rcp_ref, -hi, -lo);
+		check_math<T>([](P x) { return rcp(x, exact{}); }, rcp_ref, lo, hi, T{0});
+	}
+
+	SECTION("division for T = " + std::string{fp_name<T>::value}) {
+		check_math<T>([](P x) { return div(P{T{3}}, x, fast{}); }, div_ref, lo, hi, fast_tol);
+		check_math<T>([](P x) { return div(P{T{3}}, x, standard{}); }, div_ref, lo, hi);
+		check_math<T>([](P x) { return div(P{T{3}}, x, exact{}); }, div_ref, lo, hi, T{0});
+	}
+
+	SECTION("division by sqrt for T = " + std::string{fp_name<T>::value}) {
+		auto const ref = [](T x) { return T{3} / std::sqrt(x); };
+		check_math<T>([](P x) { return T{3} / sqrt(x, fast{}); }, ref, lo, hi, fast_tol);
+		check_math<T>([](P x) { return P{T{3}} / sqrt(x, standard{}); }, ref, lo, hi);
+		check_math<T>([](P x) { return T{3} / sqrt(x, exact{}); }, ref, lo, hi, T{0});
+
+		// The conversion is always the IEEE square root
+		check_math<T>([](P x) { return P(sqrt(x, fast{})); }, [](T x) { return std::sqrt(x); }, lo, hi, T{0});
+	}
+}
+
+void test_precision_range() {
+	using P = scimd::pack<double>;
+	using scimd::precision::standard;
+	constexpr auto N = P::size;
+
+	// Doubles whose reciprocal (or reciprocal square root) is not a normal float
+	double const args[] = {1e300, -1e300, 1e-300, -1e-300, 1e39, 1e-39, 1e-310, 1e308};
+	auto const close = [](double x, double expected) {
+		return x == expected || std::abs(x - expected) <= 8 * std::numeric_limits<double>::epsilon() * std::abs(expected);
+	};
+
+	SECTION("reciprocals outside the range of float for T = double") {
+		for (double a : args) {
+			INFO("x = " << a);
+
+			// Keep an in-range lane beside each argument so both paths share a pack
+			alignas(P) std::array<double, N> in, out;
+			in.fill(a);
+			in[0] = 2.0;
+			P x;
+			x.load(in.data());
+
+			rcp(x, standard{}).store(out.data());
+			for (size_t i = 0; i < N; i++) {
+				REQUIRE(close(out[i], 1.0 / in[i]));
+			}
+
+			// Division multiplies by the reciprocal, which overflows for subnormals
+			if (std::isnormal(1.0 / a)) {
+				div(P{1e-300}, x, standard{}).store(out.data());
+				for (size_t i = 0; i < N; i++) {
+					REQUIRE(close(out[i], 1e-300 / in[i]));
+				}
+			}
+
+			if (a > 0) {
+				rsqrt(x, standard{}).store(out.data());
+				for (size_t i = 0; i < N; i++) {
+					REQUIRE(close(out[i], 1.0 / std::sqrt(in[i])));
+				}
+			}
+		}
+	}
+}
+
+template <typename T>
+void test_multipack() {
+	// An odd number of registers covers the uneven pairing in the reductions
+	using M = scimd::multipack<T, 3>;
+	constexpr auto N = M::size;
+	constexpr auto W = scimd::pack<T>::size;
+	alignas(scimd::pack<T>) std::array<T, N> input, out;
+	std::iota(std::begin(input), std::end(input), T{1});
+
+	SECTION("multipack load/store for T = " + std::string{fp_name<T>::value}) {
+		M x;
+		REQUIRE(x.load(scimd::memory::aligned{}, input.data()) == input.data() + N);
+		REQUIRE(x.store(scimd::memory::aligned{}, out.data()) == out.data() + N);
+		REQUIRE(input == out);
+		REQUIRE(x.val[1].store(out.data()) == out.data() + W);
+		REQUIRE(out[0] == input[W]);
+
+		// Stop partway through the second register
+		auto const n = W + W / 2 + 1;
+		out.fill(T{-1});
+		REQUIRE(x.load_n(input.data(), n) == input.data() + n);
+		REQUIRE(x.store(out.data()) == out.data() + N);
+		for (size_t i = 0; i < N; i++) {
+			REQUIRE(out[i] == (i < n ? input[i] : T{0}));
+		}
+		out.fill(T{-1});
+		REQUIRE(M{T{7}}.store_n(out.data(), n) == out.data() + n);
+		for (size_t i = 0; i < N; i++) {
+			REQUIRE(out[i] == (i < n ? T{7} : T{-1}));
+		}
+	}
+
+	SECTION("multipack operators for T = " + std::string{fp_name<T>::value}) {
+		M x;
+		x.load(input.data());
+		auto y = fma(x, x, T{2} * x) - x / M{T{2}};
+		y.store(out.data());
+		for (size_t i = 0; i < N; i++) {
+			REQUIRE(out[i] == input[i] * input[i] + T{2} * input[i] - input[i] / T{2});
+		}
+
+		T const mid = static_cast<T>(N / 2);
+		auto const mask = x > M{mid};
+		REQUIRE(any(mask));
+		REQUIRE(!all(mask));
+		REQUIRE(all(x >= T{1}));
+		REQUIRE(none(x < T{1}));
+		M z{T{0}};
+		z.blend(x, mask).store(out.data());
+		for (size_t i = 0; i < N; i++) {
+			REQUIRE(out[i] == (input[i] > mid ? input[i] : T{0}));
+		}
+
+		M{sqrt(x * x)}.store(out.data());
+		REQUIRE(input == out);
+		rsqrt(x * x, scimd::precision::exact{}).store(out.data());
+		for (size_t i = 0; i < N; i++) {
+			REQUIRE(out[i] == T{1} / input[i]);
+		}
+		(T{1} / sqrt(x * x, scimd::precision::exact{})).store(out.data());
+		for (size_t i = 0; i < N; i++) {
+			REQUIRE(out[i] == T{1} / input[i]);
+		}
+		(x / sqrt(x * x)).store(out.data());
+		for (size_t i = 0; i < N; i++) {
+			REQUIRE(std::abs(out[i] - T{1}) <= 4 * std::numeric_limits<T>::epsilon());
+		}
+	}
+
+	SECTION("multipack reductions for T = " + std::string{fp_name<T>::value}) {
+		M x;
+		x.load(input.data());
+		REQUIRE(reduce_add(x) == std::accumulate(std::begin(input), std::end(input), T{0}));
+		REQUIRE(reduce_mul(M{T{2}}) == std::ldexp(T{1}, static_cast<int>(N)));
+		REQUIRE(reduce_min(x) == T{1});
+		REQUIRE(reduce_max(x) == static_cast<T>(N));
+		REQUIRE(reduce_max(-abs(x)) == T{-1});
+	}
+}
+
+template <typename T>
+void test_soa() {
+	constexpr auto N = scimd::pack<T>::size;
+	using P = scimd::pack<T>;
+
+	SECTION("soa padding and alignment for T = " + std::string{fp_name<T>::value}) {
+		scimd::soa<T, T, double> s(N + 1);
+		REQUIRE(s.size() == N + 1);
+		REQUIRE(s.padded_size() % scimd::pack<double>::size == 0);
+		REQUIRE(s.padded_size() % N == 0);
+		REQUIRE(s.padded_size() >= N + 1);
+		REQUIRE(reinterpret_cast<uintptr_t>(s.template data<0>()) % alignof(P) == 0);
+		REQUIRE(reinterpret_cast<uintptr_t>(s.template data<2>()) % alignof(scimd::pack<double>) == 0);
+
+		s.push_back(T{1}, T{2}, 3.0);
+		REQUIRE(s.size() == N + 2);
+		REQUIRE(std::get<0>(s[N + 1]) == T{1});
+		REQUIRE(s.template get<1>(N + 1) == T{2});
+		REQUIRE(s.template get<2>(N + 1) == 3.0);
+
+		// Shrinking zeroes what becomes padding
+		s.resize(N + 1);
+		s.resize(N + 2);
+		REQUIRE(s.template get<0>(N + 1) == T{0});
+		for (size_t i = s.size(); i < s.padded_size(); i++) {
+			REQUIRE(s.template get<1>(i) == T{0});
+		}
+	}
+
+	SECTION("soa pack-wise iteration for T = " + std::string{fp_name<T>::value}) {
+		scimd::soa<T, T> s(3 * N + 1);
+		for (size_t i = 0; i < s.size(); i++) {
+			s[i] = std::make_tuple(static_cast<T>(i), T{2});
+		}
+		size_t steps = 0;
+		for (auto it = s.pack_begin(); it != s.pack_end(); ++it, ++steps) {
+			REQUIRE(it.index() == steps * N);
+			auto p = *it;
+			std::get<0>(p) = fma(std::get<0>(p), std::get<1>(p), P{T{1}});
+			it.store(p);
+		}
+		REQUIRE(steps == s.padded_size() / N);
+		for (size_t i = 0; i < s.size(); i++) {
+			REQUIRE(s.template get<0>(i) == static_cast<T>(2 * i + 1));
+		}
+
+		auto const x = s.template load<0>(N);
+		s.template store<1>(N, x);
+		REQUIRE(s.template get<1>(N) == static_cast<T>(2 * N + 1));
+	}
+}
+
+template <typename T>
+void test_aosoa() {
+	constexpr auto N = scimd::pack<T>::size;
+	using A = scimd::aosoa<T, 3>;
+
+	// Two full tiles and a partial one
+	constexpr size_t n = 2 * N + N / 2 + 1;
+	std::array<T, 3 * n> aos;
+	std::iota(std::begin(aos), std::end(aos), T{1});
+
+	SECTION("aosoa layout for T = " + std::string{fp_name<T>::value}) {
+		A a;
+		a.from_aos(aos.data(), n);
+		REQUIRE(a.size() == n);
+		REQUIRE(a.tiles() == 3);
+		REQUIRE(reinterpret_cast<uintptr_t>(a.tile(1)) % alignof(scimd::pack<T>) == 0);
+		for (size_t i = 0; i < n; i++) {
+			for (size_t f = 0; f < 3; f++) {
+				REQUIRE(a.get(f, i) == aos[3 * i + f]);
+			}
+		}
+
+		alignas(scimd::pack<T>) std::array<T, N> out;
+		a.load(1, 2).store(out.data());
+		for (size_t i = 0; i < N; i++) {
+			REQUIRE(out[i] == aos[3 * (N + i) + 2]);
+		}
+		if (n % N != 0) {
+			a.load(2, 0).store(out.data());
+			REQUIRE(out[N - 1] == T{0});
+		}
+
+		std::array<T, 3 * n> back;
+		a.to_aos(back.data());
+		REQUIRE(back == aos);
+	}
+
+	SECTION("aosoa conversion to and from soa for T = " + std::string{fp_name<T>::value}) {
+		A a;
+		a.from_aos(aos.data(), n);
+		scimd::soa<T, T, T> s;
+		a.to_soa(s);
+		REQUIRE(s.size() == n);
+		for (size_t i = 0; i < n; i++) {
+			REQUIRE(s.template get<1>(i) == aos[3 * i + 1]);
+		}
+		if (n % N != 0) {
+			REQUIRE(s.template get<1>(n) == T{0});
+		}
+
+		A b;
+		b.from_soa(s);
+		std::array<T, 3 * n> back;
+		b.to_aos(back.data());
+		REQUIRE(back == aos);
+
+		// Shrinking zeroes what becomes padding
+		b.resize(n - 1);
+		b.resize(n);
+		REQUIRE(b.get(0, n - 1) == T{0});
+	}
+}
+
+void test_thread_pool() {
+	scimd::thread_pool pool{4};
+	REQUIRE(pool.size() == 4);
+	std::vector<int> hits(1000);
+
+	SECTION("run calls each task once") {
+		pool.run(hits.size(), [&hits](size_t i) { hits[i]++; });
+		REQUIRE(std::all_of(hits.begin(), hits.end(), [](int h) { return h == 1; }));
+
+		// Nested calls run inline
+		std::vector<int> inner(16 * 16);
+		pool.run(16, [&pool, &inner](size_t i) {
+			pool.run(16, [&inner, i](size_t j) { inner[16 * i + j]++; });
+		});
+		REQUIRE(std::all_of(inner.begin(), inner.end(), [](int h) { return h == 1; }));
+	}
+
+	SECTION("run rethrows the exception of a task") {
+		REQUIRE_THROWS_AS(pool.run(100, [](size_t i) { if (i == 42) { throw std::runtime_error{"task"}; } }), std::runtime_error);
+
+		// The pool is still usable afterwards
+		pool.run(hits.size(), [&hits](size_t i) { hits[i]++; });
+		REQUIRE(std::all_of(hits.begin(), hits.end(), [](int h) { return h == 1; }));
+	}
+
+	SECTION("outside threads share the pool (as they share the default pool)") {
+		std::atomic<int> wrong{0};
+		auto caller = [&pool, &wrong]() {
+			for (size_t k = 0; k < 2000; k++) {
+				std::atomic<int> count{0};
+				pool.run(16, [&count](size_t) {
+					std::this_thread::yield();
+					count++;
+				});
+				std::vector<float> x(1000 + k, 1.0f);
+				float const sum = scimd::transform_reduce(pool, x.data(), x.data() + x.size(), 0.0f, scimd::plus<float>{}, [](scimd::pack<float> v) { return v; });
+				if (count != 16 || sum != static_cast<float>(x.size())) {
+					wrong++;
+				}
+			}
+		};
+		std::thread other{caller};
+		caller();
+		other.join();
+		REQUIRE(wrong == 0);
+	}
+}
+
+void test_work_stealing() {
+	scimd::thread_pool pool{4, false};
+
+	SECTION("idle threads steal the rest of a busy block") {
+		/*
+		 * 	All of the cost is in the first thread's block, so the other
+		 * 	threads finish theirs at once and have to steal the rest of it.
+		 */
+		std::vector<std::atomic<int>> hits(64);
+		for (auto& h : hits) { h = 0; }
+		size_t const before = pool.steals();
+		pool.run(hits.size(), [&hits](size_t i) {
+			if (i < 16) {
+				std::this_thread::sleep_for(std::chrono::milliseconds{2});
+			}
+			hits[i]++;
+		});
+		REQUIRE(std::all_of(hits.begin(), hits.end(), [](std::atomic<int> const& h) { return h == 1; }));
+		REQUIRE(pool.steals() > before);
+	}
+
+	SECTION("parallel_for chunks start on pack boundaries and cover the range exactly once") {
+		constexpr size_t N = scimd::pack<float>::size;
+		size_t const n = 1000 * N + 3;
+		std::vector<std::atomic<int>> covered(n);
+		for (auto& c : covered) { c = 0; }
+		std::atomic<bool> aligned{true};
+		scimd::parallel_for<float>(pool, n, [&covered, &aligned](size_t begin, size_t end) {
+			aligned = aligned && (begin % N == 0);
+			for (size_t i = begin; i < end; i++) {
+				covered[i]++;
+			}
+		}, 5);
+		REQUIRE(aligned);
+		REQUIRE(std::all_of(covered.begin(), covered.end(), [](std::atomic<int> const& c) { return c == 1; }));
+	}
+}
+
+template <typename T>
+void test_parallel() {
+	using P = scimd::pack<T>;
+	scimd::thread_pool pool{4};
+
+	// Several chunks, and start one element past an aligned boundary so there is a peel and a tail
+	size_t const n = 3 * scimd::detail::chunk_size<T>(2 * sizeof(T)) + 5;
+	std::vector<T, scimd::allocator<T, 64>> x(n + 1), y(n + 1), out(n + 1);
+	for (size_t i = 0; i <= n; i++) {
+		x[i] = static_cast<T>(i % 7);
+		y[i] = static_cast<T>(i % 5);
+	}
+	T const* const first = x.data() + 1;
+	T const* const last = first + n;
+
+	SECTION("parallel transform for T = " + std::string{fp_name<T>::value}) {
+		out.back() = T{-1};
+		REQUIRE(scimd::transform(pool, first, last, out.data(), [](P v) { return v * v + T{1}; }) == out.data() + n);
+		bool same = true;
+		for (size_t i = 0; i < n; i++) {
+			same &= (out[i] == first[i] * first[i] + T{1});
+		}
+		REQUIRE(same);
+		REQUIRE(out.back() == T{-1});
+
+		// Misaligned against the output, and a second input with yet another alignment
+		scimd::transform(pool, first, last, y.data(), out.data() + 1, [](P a, P b) { return fma(a, b, a); });
+		for (size_t i = 0; i < n; i++) {
+			same &= (out[i + 1] == first[i] * y[i] + first[i]);
+		}
+		REQUIRE(same);
+
+		scimd::for_each(pool, out.data() + 1, out.data() + n + 1, [](P& v) { v = -v; });
+		for (size_t i = 0; i < n; i++) {
+			same &= (out[i + 1] == -(first[i] * y[i] + first[i]));
+		}
+		REQUIRE(same);
+
+		// Shorter than a pack
+		scimd::transform(pool, first, first + 1, out.data(), [](P v) { return v + T{3}; });
+		REQUIRE(out[0] == first[0] + T{3});
+	}
+
+	SECTION("parallel copy for T = " + std::string{fp_name<T>::value}) {
+		out.back() = T{-1};
+		REQUIRE(scimd::copy(pool, first, last, out.data()) == out.data() + n);
+		REQUIRE(std::equal(first, last, out.data()));
+		REQUIRE(out.back() == T{-1});
+
+		// The streaming path is only taken above the size of the LLC, so run its chunk directly
+		std::fill(out.begin(), out.end(), T{0});
+		scimd::detail::transform_chunk<scimd::memory::streaming>(x.data(), out.data(), n - n % P::size, true, [](P v) { return v * v; });
+		scimd::memory::sfence();
+		bool same = true;
+		for (size_t i = 0; i < n - n % P::size; i++) {
+			same &= (out[i] == x[i] * x[i]);
+		}
+		REQUIRE(same);
+	}
+
+	SECTION("parallel transform_reduce for T = " + std::string{fp_name<T>::value}) {
+		// The values are small integers, so every order of summation is exact
+		T expected = T{2};
+		for (size_t i = 0; i < n; i++) {
+			expected += first[i] * first[i];
+		}
+		auto const square = [](P v) { return v * v; };
+		REQUIRE(scimd::transform_reduce(pool, first, last, T{2}, scimd::plus<T>{}, square) == expected);
+		REQUIRE(scimd::transform_reduce(pool, first, last, T{100}, scimd::minimum<T>{}, square) == T{0});
+		REQUIRE(scimd::transform_reduce(pool, first, last, T{0}, scimd::maximum<T>{}, [](P v) { return -v; }) == T{0});
+		REQUIRE(scimd::transform_reduce(pool, first, first, T{2}, scimd::plus<T>{}, square) == T{2});
+		REQUIRE(scimd::transform_reduce(first + 1, first + 4, T{1}, scimd::multiplies<T>{}, [](P v) { return v + T{1}; }) == T{60});
+	}
+}
+
+template <typename T>
+void test_expr() {
+	using P = scimd::pack<T>;
+	constexpr auto N = P::size;
+
+	// Two full packs and a partial one
+	constexpr size_t n = 2 * N + N / 2 + 1;
+	std::vector<T, scimd::allocator<T, 64>> a(n), b(n), c(n), d(n);
+	for (size_t i = 0; i < n; i++) {
+		a[i] = static_cast<T>(i + 1);
+		b[i] = static_cast<T>(i % 3) - T{1};
+		d[i] = static_cast<T>(i * i);
+	}
+	scimd::array_view<T> va{a}, vb{b}, vc{c}, vd{d};
+
+	// The result of the same operations on packs
+	auto const expected = [&](P (*f)(P, P, P)) {
+		std::vector<T> out(n);
+		for (size_t i = 0; i < n; i += N) {
+			size_t const k = std::min(N, n - i);
+			P x, y, z;
+			x.load_n(&a[i], k);
+			y.load_n(&b[i], k);
+			z.load_n(&d[i], k);
+			f(x, y, z).store_n(&out[i], k);
+		}
+		return out;
+	};
+	auto const same = [&](std::vector<T> const& e) { return std::equal(e.begin(), e.end(), c.begin()); };
+
+	SECTION("expressions for T = " + std::string{fp_name<T>::value}) {
+		vc = va * vb + sqrt(vd);
+		REQUIRE(same(expected([](P x, P y, P z) { return fma(x, y, P{sqrt(z)}); })));
+
+		vc = vd - va * vb;
+		REQUIRE(same(expected([](P x, P y, P z) { return fnma(x, y, z); })));
+
+		vc = va * vb - T{2} * vd;
+		REQUIRE(same(expected([](P x, P y, P z) { return fms(x, y, P{T{2}} * z); })));
+
+		vc = -(va + T{1}) / max(vb, T{0.5}) + abs(vb);
+		REQUIRE(same(expected([](P x, P y, P) { return -(x + T{1}) / max(y, P{T{0.5}}) + abs(y); })));
+
+		vc = scimd::expr::map(va, [](P x) { return x * x; });
+		vc *= va;
+		REQUIRE(same(expected([](P x, P, P) { return x * x * x; })));
+
+		vc = T{3};
+		REQUIRE(std::all_of(c.begin(), c.end(), [](T x) { return x == T{3}; }));
+	}
+
+	SECTION("expression fusion for T = " + std::string{fp_name<T>::value}) {
+		using scimd::expr::ternary;
+		using scimd::expr::fma_op;
+		using scimd::expr::fms_op;
+		using scimd::expr::fnma_op;
+		static_assert(std::is_same<decltype(va * vb + vd), ternary<fma_op, decltype(va), decltype(vb), decltype(vd)>>::value, "a*b + c fuses into fma");
+		static_assert(std::is_same<decltype(vd + va * vb), ternary<fma_op, decltype(va), decltype(vb), decltype(vd)>>::value, "c + a*b fuses into fma");
+		static_assert(std::is_same<decltype(va * vb - vd), ternary<fms_op, decltype(va), decltype(vb), decltype(vd)>>::value, "a*b - c fuses into fms");
+		static_assert(std::is_same<decltype(vd - va * vb), ternary<fnma_op, decltype(va), decltype(vb), decltype(vd)>>::value, "c - a*b fuses into fnma");
+	}
+
+	SECTION("expression sizes for T = " + std::string{fp_name<T>::value}) {
+		scimd::array_view<T> shorter{a.data(), n - 1};
+		REQUIRE_THROWS_AS(va + shorter, std::invalid_argument);
+		REQUIRE_THROWS_AS(shorter = va * T{2}, std::invalid_argument);
+
+		// Nothing past the end is written
+		c.push_back(T{-1});
+		scimd::array_view<T> part{c.data(), n};
+		part = va;
+		REQUIRE(c.back() == T{-1});
+		REQUIRE(std::equal(a.begin(), a.end(), c.begin()));
+	}
+}
+
+template <typename T>
+void test_indirect() {
+	using P = scimd::pack<T>;
+	constexpr auto N = P::size;
+
+	// Two full packs and a partial one, with indices in reverse and repeated
+	constexpr size_t m = 5 * N;
+	constexpr size_t n = 2 * N + N / 2 + 1;
+	std::vector<T> x(m), y(m);
+	for (size_t i = 0; i < m; i++) {
+		x[i] = static_cast<T>(i);
+		y[i] = static_cast<T>(2 * i + 1);
+	}
+	std::vector<int32_t> index(n);
+	for (size_t i = 0; i < n; i++) {
+		index[i] = static_cast<int32_t>((m - 1 - 3 * i) % m);
+	}
+
+	SECTION("indirect loop for T = " + std::string{fp_name<T>::value}) {
+		for (size_t distance : {size_t{0}, size_t{1}, size_t{4}}) {
+			std::vector<T> out(n + N, T{-1});
+			size_t calls = 0;
+			scimd::for_each_indirect(index.data(), n, distance, [&out, &calls](size_t i, P a, P b) {
+				REQUIRE(i == calls * N);
+				(a * b).store(&out[i]);
+				calls++;
+			}, x.data(), y.data());
+			REQUIRE(calls == (n + N - 1) / N);
+
+			bool same = true;
+			for (size_t i = 0; i < n; i++) {
+				same &= (out[i] == x[static_cast<size_t>(index[i])] * y[static_cast<size_t>(index[i])]);
+			}
+			REQUIRE(same);
+			// The lanes past the end are zero
+			REQUIRE(out[n] == (n % N == 0 ? T{-1} : T{0}));
+		}
+	}
+
+	SECTION("prefetch for T = " + std::string{fp_name<T>::value}) {
+		// Only hints, so just check that they compile and don't fault
+		scimd::prefetch(x.data());
+		scimd::prefetch<2>(x.data());
+		scimd::prefetch<3>(x.data());
+		scimd::prefetch_nta(x.data());
+		scimd::prefetch_write(x.data());
+		REQUIRE(x[0] == T{0});
+	}
+}
+
+void test_numa_topology() {
+	SECTION("topology") {
+		REQUIRE(scimd::numa::detail::parse_list("0-3,8,10-11\n") == (std::vector<size_t>{0, 1, 2, 3, 8, 10, 11}));
+		REQUIRE_FALSE(scimd::numa::nodes().empty());
+
+		// Touched memory is on a node if the kernel can tell
+		std::vector<int> v(1024, 1);
+		REQUIRE(scimd::numa::node_of(v.data()) >= -1);
+	}
+
+	SECTION("broadcast calls each thread once with its own index") {
+		scimd::thread_pool pool{4};
+		std::vector<std::atomic<int>> hits(pool.size());
+		for (auto& h : hits) { h = 0; }
+		pool.broadcast([&hits](size_t t) { hits[t]++; });
+		REQUIRE(std::all_of(hits.begin(), hits.end(), [](std::atomic<int> const& h) { return h == 1; }));
+	}
+}
+
+template <typename T>
+void test_numa() {
+	using P = scimd::pack<T>;
+	scimd::thread_pool pool{4, false};
+
+	SECTION("partitioned array for T = " + std::string{fp_name<T>::value}) {
+		size_t const page = static_cast<size_t>(sysconf(_SC_PAGESIZE)) / sizeof(T);
+		size_t const n = 10 * page + 3;
+		scimd::partitioned_array<T> a{pool, n};
+		REQUIRE(a.size() == n);
+		REQUIRE(reinterpret_cast<uintptr_t>(a.data()) % sizeof(P) == 0);
+		REQUIRE(std::all_of(a.data(), a.data() + n, [](T x) { return x == T{0}; }));
+
+		// One partition per thread, covering the array on page boundaries
+		auto const& parts = a.partitions();
+		REQUIRE(parts.size() == pool.size());
+		REQUIRE(parts.front().begin == 0);
+		REQUIRE(parts.back().end == n);
+		for (size_t t = 0; t < parts.size(); t++) {
+			// Each partition starts on a page of its own
+			REQUIRE(reinterpret_cast<uintptr_t>(a.data() + parts[t].begin) % (page * sizeof(T)) == 0);
+			REQUIRE(parts[t].begin < parts[t].end);
+			REQUIRE(parts[t].node >= 0);
+			if (t > 0) {
+				REQUIRE(parts[t].begin == parts[t - 1].end);
+			}
+		}
+
+		std::vector<std::atomic<int>> calls(parts.size());
+		for (auto& c : calls) { c = 0; }
+		a.for_each_partition([&a, &parts, &calls](size_t begin, size_t end) {
+			for (size_t t = 0; t < parts.size(); t++) {
+				if (parts[t].begin == begin && parts[t].end == end) {
+					calls[t]++;
+				}
+			}
+			for (size_t i = begin; i < end; i++) {
+				a[i] = static_cast<T>(i % 7);
+			}
+		});
+		REQUIRE(std::all_of(calls.begin(), calls.end(), [](std::atomic<int> const& c) { return c == 1; }));
+		bool same = true;
+		for (size_t i = 0; i < n; i++) {
+			same &= (a[i] == static_cast<T>(i % 7));
+		}
+		REQUIRE(same);
+
+		// Too small to give every thread a page
+		scimd::partitioned_array<T> small{pool, 5};
+		REQUIRE(small.partitions().back().end == 5);
+		REQUIRE(small[4] == T{0});
+	}
+}
+
+template <typename T>
+void test_arena() {
+	using P = scimd::pack<T>;
+	constexpr auto N = P::size;
+
+	SECTION("arena for T = " + std::string{fp_name<T>::value}) {
+		scimd::arena a{1024};
+		T* x = a.allocate<T>(3);
+		T* y = a.allocate<T>(N + 1);
+		REQUIRE(reinterpret_cast<uintptr_t>(x) % sizeof(P) == 0);
+		REQUIRE(reinterpret_cast<uintptr_t>(y) % sizeof(P) == 0);
+		// Padded to a whole pack
+		REQUIRE(y >= x + N);
+		P{T{1}}.store(x);
+		P{T{2}}.store(y);
+		P{T{3}}.store(y + N);
+		REQUIRE(x[0] == T{1});
+		REQUIRE(y[0] == T{2});
+
+		// Larger than a chunk
+		T* z = a.allocate<T>(4096);
+		REQUIRE(reinterpret_cast<uintptr_t>(z) % sizeof(P) == 0);
+		std::fill(z, z + 4096, T{4});
+		REQUIRE(x[0] == T{1});
+		size_t const capacity = a.capacity();
+		REQUIRE(capacity >= 4096 * sizeof(T));
+
+		// Reset hands out the same memory again
+		a.reset();
+		REQUIRE(a.allocate<T>(3) == x);
+		REQUIRE(a.capacity() == capacity);
+	}
+
+	SECTION("arena scope for T = " + std::string{fp_name<T>::value}) {
+		scimd::arena a{1024};
+		T* before = a.allocate<T>(N);
+		T* inner = nullptr;
+		{
+			scimd::arena::scope s{a};
+			inner = a.allocate<T>(5 * N);
+			{
+				scimd::arena::scope s2{a};
+				a.allocate<T>(10000);
+			}
+			REQUIRE(a.allocate<T>(N) == inner + 5 * N);
+		}
+		REQUIRE(a.allocate<T>(5 * N) == inner);
+		// Allocations from before the scope are kept
+		REQUIRE(inner >= before + N);
+
+		// After the first timestep, the chunks are reused rather than the heap
+		auto const timestep = [&a]() {
+			scimd::arena::scope s{a};
+			a.allocate<T>(10000);
+			a.allocate<T>(10);
+		};
+		timestep();
+		size_t const capacity = a.capacity();
+		for (int step = 0; step < 10; step++) {
+			timestep();
+		}
+		REQUIRE(a.capacity() == capacity);
+	}
+
+	SECTION("arena allocator for T = " + std::string{fp_name<T>::value}) {
+		using alloc = scimd::arena_allocator<T>;
+		using traits = std::allocator_traits<alloc>;
+		static_assert(std::is_same<typename traits::template rebind_alloc<int>, scimd::arena_allocator<int>>::value, "rebind");
+
+		scimd::arena a;
+		alloc al{a};
+		REQUIRE(al == alloc{a});
+		REQUIRE(al == scimd::arena_allocator<int>{al});
+		REQUIRE(alloc{} != al);
+		REQUIRE(alloc{}.get_arena() == &scimd::thread_arena());
+
+		scimd::arena::scope s{a};
+		std::vector<T, alloc> v(al);
+		v.reserve(100);
+		for (size_t i = 0; i < 100; i++) {
+			v.push_back(static_cast<T>(i));
+		}
+		REQUIRE(reinterpret_cast<uintptr_t>(v.data()) % sizeof(P) == 0);
+		REQUIRE(v[99] == T{99});
+
+		// Moves keep the buffer
+		T const* data = v.data();
+		std::vector<T, alloc> w{std::move(v)};
+		REQUIRE(w.data() == data);
+		std::list<T, alloc> l(3, T{1}, al);
+		REQUIRE(std::accumulate(l.begin(), l.end(), T{0}) == T{3});
+
+		// Each thread has its own arena
+		scimd::arena* other = nullptr;
+		std::thread{[&other]() { other = &scimd::thread_arena(); }}.join();
+		REQUIRE(other != &scimd::thread_arena());
+	}
+}
+
+template <typename T>
+void test_compress() {
+	using P = scimd::pack<T>;
+	constexpr auto N = P::size;
+
+	SECTION("compress store for T = " + std::string{fp_name<T>::value}) {
+		alignas(P) T lanes[N];
+		for (size_t i = 0; i < N; i++) {
+			lanes[i] = static_cast<T>(i + 1);
+		}
+		P x;
+		x.load(scimd::memory::aligned{}, lanes);
+
+		// Every mask of the pack
+		bool same = true;
+		for (size_t bits = 0; bits < (size_t{1} << N); bits++) {
+			alignas(P) T selected[N];
+			for (size_t i = 0; i < N; i++) {
+				selected[i] = ((bits >> i) & 1) ? T{1} : T{0};
+			}
+			P m;
+			m.load(scimd::memory::aligned{}, selected);
+			auto const mask = (m > P{T{0}});
+
+			T out[N + 1];
+			std::fill(out, out + N + 1, T{-1});
+			size_t const count = compress_store(out, x, mask);
+			same &= (count == static_cast<size_t>(std::count(selected, selected + N, T{1})));
+			size_t k = 0;
+			for (size_t i = 0; i < N; i++) {
+				if ((bits >> i) & 1) {
+					same &= (out[k++] == lanes[i]);
+				}
+			}
+			// Only the selected lanes are written
+			same &= std::all_of(out + count, out + N + 1, [](T v) { return v == T{-1}; });
+
+			P c = compress(x, mask);
+			alignas(P) T packed[N];
+			c.store(scimd::memory::aligned{}, packed);
+			same &= std::equal(out, out + count, packed);
+		}
+		REQUIRE(same);
+	}
+
+	// Full packs and a tail, with runs of selected and unselected elements
+	size_t const n = 7 * N + N / 2 + 1;
+	std::vector<T> a(n);
+	for (size_t i = 0; i < n; i++) {
+		a[i] = static_cast<T>((i * 37) % 101);
+	}
+	auto const pred = [](P x) { return x < P{T{40}}; };
+	auto const pred1 = [](T x) { return x < T{40}; };
+
+	SECTION("copy_if for T = " + std::string{fp_name<T>::value}) {
+		std::vector<T> expected;
+		std::copy_if(a.begin(), a.end(), std::back_inserter(expected), pred1);
+
+		std::vector<T> out(n);
+		T* end = scimd::copy_if(a.data(), a.data() + n, out.data(), pred);
+		REQUIRE(static_cast<size_t>(end - out.data()) == expected.size());
+		REQUIRE(std::equal(expected.begin(), expected.end(), out.begin()));
+
+		// In place, and nothing selected
+		std::vector<T> b = a;
+		end = scimd::copy_if(b.data(), b.data() + n, b.data(), pred);
+		REQUIRE(std::equal(expected.begin(), expected.end(), b.begin()));
+		REQUIRE(scimd::copy_if(a.data(), a.data() + n, out.data(), [](P x) { return x < P{T{-1}}; }) == out.data());
+
+		// The zeros past the end of the tail are not selected
+		std::vector<T> ones(N + 1, T{1});
+		end = scimd::copy_if(ones.data() + 1, ones.data() + N, out.data(), [](P x) { return x < P{T{2}}; });
+		REQUIRE(end == out.data() + N - 1);
+	}
+
+	SECTION("partition for T = " + std::string{fp_name<T>::value}) {
+		std::vector<T> expected_true, expected_false;
+		std::partition_copy(a.begin(), a.end(), std::back_inserter(expected_true), std::back_inserter(expected_false), pred1);
+
+		std::vector<T> yes(n), no(n);
+		auto const ends = scimd::partition_copy(a.data(), a.data() + n, yes.data(), no.data(), pred);
+		REQUIRE(static_cast<size_t>(ends.first - yes.data()) == expected_true.size());
+		REQUIRE(static_cast<size_t>(ends.second - no.data()) == expected_false.size());
+		REQUIRE(std::equal(expected_true.begin(), expected_true.end(), yes.begin()));
+		REQUIRE(std::equal(expected_false.begin(), expected_false.end(), no.begin()));
+
+		// In place and stable
+		std::vector<T> b = a;
+		std::stable_partition(a.begin(), a.end(), pred1);
+		T* mid = scimd::partition(b.data(), b.data() + n, pred);
+		REQUIRE(static_cast<size_t>(mid - b.data()) == expected_true.size());
+		REQUIRE(b == a);
+	}
+}
+
+template <typename T>
+void test_mask() {
+	using P = scimd::pack<T>;
+	constexpr auto N = P::size;
+	uint32_t const full = static_cast<uint32_t>((uint64_t{1} << N) - 1);
+
+	SECTION("mask bits for T = " + std::string{fp_name<T>::value}) {
+		alignas(P) T lanes[N];
+		for (size_t i = 0; i < N; i++) {
+			lanes[i] = static_cast<T>(i);
+		}
+		P x;
+		x.load(scimd::memory::aligned{}, lanes);
+
+		bool same = true;
+		for (uint32_t bits = 0; bits <= full; bits++) {
+			auto const mask = from_bits<T>(bits);
+			same &= (to_bits(mask) == bits);
+			same &= (count(mask) == static_cast<size_t>(__builtin_popcount(bits)));
+			same &= (find_first(mask) == (bits == 0 ? N : static_cast<size_t>(__builtin_ctz(bits))));
+			same &= (all(mask) == (bits == full));
+			same &= (none(mask) == (bits == 0));
+
+			// A mask from bits works like one from a comparison
+			alignas(P) T blended[N];
+			P{T{-1}}.blend(x, mask).store(scimd::memory::aligned{}, blended);
+			for (size_t i = 0; i < N; i++) {
+				same &= (blended[i] == (((bits >> i) & 1) ? lanes[i] : T{-1}));
+			}
+		}
+		REQUIRE(same);
+
+		// Lanes [0, 2) are below 2
+		REQUIRE(to_bits(x < P{T{2}}) == (N == 1 ? 1u : 3u));
+		REQUIRE(find_first(x > P{T{0}}) == (N == 1 ? N : 1));
+		REQUIRE(count(x >= P{T{0}}) == N);
+	}
+
+	SECTION("mask algebra for T = " + std::string{fp_name<T>::value}) {
+		bool same = true;
+		for (uint32_t a = 0; a <= full; a++) {
+			// Every pair for the narrow packs, a spread of them for the wide ones
+			uint32_t const step = (N > 8) ? 0x1001u : 1u;
+			for (uint64_t b = a % step; b <= full; b += step) {
+				auto const ma = from_bits<T>(a);
+				auto const mb = from_bits<T>(static_cast<uint32_t>(b));
+				same &= (to_bits(ma && mb) == (a & b));
+				same &= (to_bits(ma || mb) == (a | b));
+				same &= (to_bits(ma ^ mb) == (a ^ b));
+			}
+			same &= (to_bits(!from_bits<T>(a)) == (~a & full));
+		}
+		REQUIRE(same);
+
+		// r < rcut && active
+		alignas(P) T lanes[N];
+		for (size_t i = 0; i < N; i++) {
+			lanes[i] = static_cast<T>(i);
+		}
+		P r;
+		r.load(scimd::memory::aligned{}, lanes);
+		auto const active = from_bits<T>(0x5555u & full);
+		auto const inside = (r < P{static_cast<T>(N / 2 + 1)}) && active;
+		uint32_t expected = 0;
+		for (size_t i = 0; i < N; i++) {
+			if (i < N / 2 + 1 && i % 2 == 0) {
+				expected |= 1u << i;
+			}
+		}
+		REQUIRE(to_bits(inside) == expected);
+		REQUIRE(to_bits(!inside && active) == ((~expected) & 0x5555u & full));
+	}
+}
+
 // Don't let the size get bigger than the underlying SIMD type
 static_assert(sizeof(scimd::pack<float>::simd_t) == sizeof(scimd::pack<float>), "scimd::pack<float> must be the size of scimd::pack<float>::simd_t");
 static_assert(sizeof(scimd::pack<double>::simd_t) == sizeof(scimd::pack<double>), "scimd::pack<double> must be the size of scimd::pack<double>::simd_t");
@@ -234,7 +1523,118 @@ TEST_CASE("mixed mode") {
 	test_mixed_mode<float>();
 	test_mixed_mode<double>();
 }
+TEST_CASE("reductions") {
+	test_reductions<float>();
+	test_reductions<double>();
+}
+TEST_CASE("gather/scatter") {
+	test_gather_scatter<float>();
+	test_gather_scatter<double>();
+	test_gather_scatter<double, int64_t>();
+}
+TEST_CASE("math") {
+	test_math<float>();
+	test_math<double>();
+}
+TEST_CASE("precision") {
+	test_precision<float>();
+	test_precision<double>();
+	test_precision_range();
+}
+TEST_CASE("multipack") {
+	test_multipack<float>();
+	test_multipack<double>();
+}
+TEST_CASE("soa") {
+	test_soa<float>();
+	test_soa<double>();
+}
+TEST_CASE("aosoa") {
+	test_aosoa<float>();
+	test_aosoa<double>();
+}
+TEST_CASE("thread pool") {
+	test_thread_pool();
+}
+TEST_CASE("work stealing") {
+	test_work_stealing();
+}
+TEST_CASE("parallel") {
+	test_parallel<float>();
+	test_parallel<double>();
+}
+TEST_CASE("expressions") {
+	test_expr<float>();
+	test_expr<double>();
+}
+TEST_CASE("indirect") {
+	test_indirect<float>();
+	test_indirect<double>();
+}
 TEST_CASE("memory") {
 	test_memory<float>();
 	test_memory<double>();
 }
+TEST_CASE("numa") {
+	test_numa_topology();
+	test_numa<float>();
+	test_numa<double>();
+}
+TEST_CASE("arena") {
+	test_arena<float>();
+	test_arena<double>();
+}
+TEST_CASE("compress") {
+	test_compress<float>();
+	test_compress<double>();
+}
+TEST_CASE("masks") {
+	test_mask<float>();
+	test_mask<double>();
+}
+// isa_kernel.cpp, compiled for two instruction sets
+namespace scimd {
+	namespace isa_scalar { size_t isa_kernel(float const*, size_t, float&); }
+	namespace isa_sse { size_t isa_kernel(float const*, size_t, float&); }
+}
+
+TEST_CASE("dispatch") {
+	using scimd::dispatch::isa;
+
+	// This binary is running, so the CPU must support what it was compiled for
+	REQUIRE(static_cast<int>(scimd::dispatch::active()) >= static_cast<int>(scimd::current_isa));
+
+	using fn_t = scimd::dispatch::function<int(int)>;
+	auto scalar = [](int x) { return x + 1; };
+	auto sse = [](int x) { return x + 2; };
+	auto avx512 = [](int x) { return x + 5; };
+
+	SECTION("selects the best implementation not exceeding the CPU") {
+		fn_t f{isa::avx, scalar, sse, nullptr, nullptr, avx512};
+		REQUIRE(f.target() == isa::sse);
+		REQUIRE(f(0) == 2);
+
+		fn_t g{isa::avx512, scalar, sse, nullptr, nullptr, avx512};
+		REQUIRE(g.target() == isa::avx512);
+		REQUIRE(g(0) == 5);
+	}
+
+	SECTION("throws when no implementation is usable") {
+		REQUIRE_THROWS_AS((fn_t{isa::scalar, nullptr, sse, nullptr, nullptr, nullptr}), std::runtime_error);
+	}
+
+	SECTION("links one kernel compiled for several instruction sets") {
+		std::vector<float> x(37);
+		std::iota(x.begin(), x.end(), 1.0f);
+		float sum = 0;
+
+		REQUIRE(scimd::isa_scalar::isa_kernel(x.data(), x.size(), sum) == 1);
+		REQUIRE(sum == 703.0f);
+
+		scimd::dispatch::function<size_t(float const*, size_t, float&)> kernel{
+			scimd::isa_scalar::isa_kernel, scimd::isa_sse::isa_kernel, nullptr, nullptr, nullptr};
+		sum = 0;
+		REQUIRE(kernel(x.data(), x.size(), sum) == (kernel.target() == isa::sse ? 4u : 1u));
+		REQUIRE(sum == 703.0f);
+	}
+}
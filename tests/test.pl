@@ -3,7 +3,8 @@ use warnings;
 use Getopt::Long qw(GetOptions);
 
 my $runavx512 = 0;
-GetOptions('run-avx512!', \$runavx512);
+my $runknl = 0;
+GetOptions('run-avx512!', \$runavx512, 'run-knl!', \$runknl);
 
 sub execute($) {
 	my $cmd = shift;
@@ -17,13 +18,13 @@ my @compilers = (@ARGV) ? @ARGV : (
 	'clang++-3.7', 'clang++-3.8', 'clang++-3.9', 'clang++-4.0', 'clang++-6.0'
 	);
 
-my @architectures = ('sse', 'avx', 'fma', 'scalar', 'avx512');
+my @architectures = ('sse', 'avx', 'fma', 'scalar', 'avx512', 'knl');
 
 for my $c (@compilers) {
 	ARCH: for my $arch (@architectures) {
 		print "$c, $arch : ";
 
-		if($arch eq 'avx512') {
+		if($arch eq 'avx512' || $arch eq 'knl') {
 			$c =~ /\+\+\-(.+)/;
 			my $ver = $1;
 			my $unsupported_compiler =
@@ -35,7 +36,7 @@ for my $c (@compilers) {
 			}
 		}
 		execute("make CXX=$c clean $arch");
-		if($arch eq 'avx512' && !$runavx512) {
+		if(($arch eq 'avx512' && !$runavx512) || ($arch eq 'knl' && !$runknl)) {
 			print "Compiled but not run\n";
 			next ARCH;
 		}
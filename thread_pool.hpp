@@ -0,0 +1,335 @@
+#pragma once
+
+#include <pthread.h>
+#include <sched.h>
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <vector>
+
+namespace scimd {
+	namespace detail {
+		// Set while a thread is running tasks for any pool
+		inline bool& inside_pool() {
+			static thread_local bool inside = false;
+			return inside;
+		}
+
+		/*
+		 * 	The tasks [begin, end) still owned by one thread
+		 *
+		 * 	Both bounds live in one word so that the owner (taking from the
+		 * 	front) and the thieves (taking the back half) only need a CAS.
+		 * 	Each bound has 32 bits, so a range holds at most `limit` tasks.
+		 * 	The alignment keeps each range on its own cache line.
+		 */
+		struct alignas(64) task_range {
+			static constexpr uint64_t limit = 0xffffffffu;
+
+			std::atomic<uint64_t> bounds{0};
+
+			static uint64_t pack(uint64_t begin, uint64_t end) noexcept { return (begin << 32) | end; }
+			static uint64_t begin(uint64_t b) noexcept { return b >> 32; }
+			static uint64_t end(uint64_t b) noexcept { return b & 0xffffffffu; }
+
+			void reset(uint64_t begin, uint64_t end) noexcept {
+				bounds.store(pack(begin, end), std::memory_order_relaxed);
+			}
+
+			// The owner takes the first task
+			bool pop(size_t& task) noexcept {
+				uint64_t b = bounds.load(std::memory_order_relaxed);
+				while (begin(b) < end(b)) {
+					if (bounds.compare_exchange_weak(b, pack(begin(b) + 1, end(b)), std::memory_order_acquire, std::memory_order_relaxed)) {
+						task = static_cast<size_t>(begin(b));
+						return true;
+					}
+				}
+				return false;
+			}
+
+			// A thief takes the back half (rounded up) of the remaining tasks
+			bool steal(uint64_t& first, uint64_t& last) noexcept {
+				uint64_t b = bounds.load(std::memory_order_relaxed);
+				while (begin(b) < end(b)) {
+					uint64_t const mid = begin(b) + (end(b) - begin(b)) / 2;
+					if (bounds.compare_exchange_weak(b, pack(begin(b), mid), std::memory_order_acquire, std::memory_order_relaxed)) {
+						first = mid;
+						last = end(b);
+						return true;
+					}
+				}
+				return false;
+			}
+		};
+		static_assert(sizeof(task_range) == 64, "A task_range must fill one cache line");
+
+		// new[] only honors alignas(64) from C++17 on
+		struct task_range_deleter {
+			void operator()(task_range* p) const noexcept { std::free(p); }
+		};
+
+		inline std::unique_ptr<task_range[], task_range_deleter> make_task_ranges(size_t n) {
+			void* p = nullptr;
+			if (posix_memalign(&p, alignof(task_range), n * sizeof(task_range)) != 0) {
+				throw std::bad_alloc{};
+			}
+			task_range* const ranges = static_cast<task_range*>(p);
+			for (size_t i = 0; i < n; i++) {
+				new (ranges + i) task_range{};
+			}
+			return std::unique_ptr<task_range[], task_range_deleter>{ranges};
+		}
+	}
+
+	/**
+	 * \brief A work-stealing pool of threads for data-parallel loops
+	 *
+	 * run(n, f) calls f(i) for every i in [0, n) and returns once all of the
+	 * calls have finished. The calling thread takes part, so a pool of size
+	 * one has no workers and runs everything inline.
+	 *
+	 * The tasks are first split into one contiguous block per thread, so a
+	 * balanced loop runs like a static schedule with each thread walking its
+	 * block in order. A thread that runs out of tasks steals the back half of
+	 * the remaining block of a random victim, which rebalances loops whose
+	 * tasks have uneven costs. Taking and stealing tasks are a single CAS
+	 * each; the only lock is taken once per thread to start and finish run().
+	 * Loops of 2^32 tasks or more run as consecutive chunks of 2^32 - 1.
+	 *
+	 * Worker `i` is pinned to the `i`th CPU in the process's affinity mask
+	 * unless `pin` is false or there are more threads than CPUs. The calling
+	 * thread is never pinned.
+	 *
+	 * A call to run() from inside a task runs serially on that thread
+	 * instead of deadlocking the pool. If a task throws, the tasks that are
+	 * still queued are dropped and the first exception is rethrown from run().
+	 *
+	 * run() and broadcast() may be called concurrently from any number of
+	 * outside threads (e.g., through the shared default_pool()). The calls
+	 * take turns, each getting the whole pool.
+	 */
+	class thread_pool {
+	public:
+		explicit thread_pool(size_t threads = std::thread::hardware_concurrency(), bool pin = true)
+			: ranges_{detail::make_task_ranges(std::max<size_t>(threads, 1))} {
+			threads = std::max<size_t>(threads, 1);
+			std::vector<size_t> const cpus = allowed_cpus();
+			pin = pin && threads <= cpus.size();
+			workers_.reserve(threads - 1);
+			for (size_t i = 1; i < threads; i++) {
+				workers_.emplace_back([this, i]() { this->work(i); });
+				if (pin) {
+					cpu_set_t set;
+					CPU_ZERO(&set);
+					CPU_SET(cpus[i], &set);
+					pthread_setaffinity_np(workers_.back().native_handle(), sizeof(set), &set);
+				}
+			}
+		}
+		~thread_pool() {
+			{
+				std::lock_guard<std::mutex> lock{mutex_};
+				stop_ = true;
+			}
+			wake_.notify_all();
+			for (auto& t : workers_) {
+				t.join();
+			}
+		}
+		thread_pool(thread_pool const&) = delete;
+		thread_pool& operator=(thread_pool const&) = delete;
+
+		/**
+		 * \brief The number of threads, including the caller of run()
+		 */
+		size_t size() const noexcept { return workers_.size() + 1; }
+
+		/**
+		 * \brief The number of successful steals since the pool was created
+		 */
+		size_t steals() const noexcept { return steals_.load(std::memory_order_relaxed); }
+
+		template <typename F>
+		void run(size_t tasks, F&& f) {
+			if (workers_.empty() || tasks < 2 || detail::inside_pool()) {
+				for (size_t i = 0; i < tasks; i++) {
+					f(i);
+				}
+				return;
+			}
+			// A range holds 32-bit bounds, so larger loops run in chunks
+			uint64_t const limit = detail::task_range::limit;
+			for (uint64_t first = 0; first < tasks; first += limit) {
+				size_t const base = static_cast<size_t>(first);
+				auto chunk = [&f, base](size_t i) { f(base + i); };
+				start(static_cast<size_t>(std::min<uint64_t>(tasks - first, limit)), chunk, true);
+			}
+		}
+
+		/**
+		 * \brief Call f(t) once on each thread, where t in [0, size()) is the thread's index
+		 *
+		 * Thread 0 is the caller of broadcast(). Nothing is stolen, so with
+		 * pinned workers, the call for a given `t` always runs on the same CPU
+		 * (e.g., to first-touch memory on the NUMA node that will use it).
+		 * Nested calls run serially on the calling thread.
+		 */
+		template <typename F>
+		void broadcast(F&& f) {
+			if (workers_.empty() || detail::inside_pool()) {
+				for (size_t t = 0; t < size(); t++) {
+					f(t);
+				}
+				return;
+			}
+			start(size(), f, false);
+		}
+
+	private:
+		std::vector<std::thread> workers_;
+		std::unique_ptr<detail::task_range[], detail::task_range_deleter> ranges_;
+		std::atomic<size_t> remaining_{0};
+		std::atomic<size_t> steals_{0};
+		std::mutex mutex_;
+		// Held for a whole run() or broadcast() so that outside callers take turns
+		std::mutex run_mutex_;
+		std::condition_variable wake_, done_;
+		std::function<void(size_t)> task_;
+		size_t active_{0};
+		uint64_t generation_{0};
+		bool stop_{false};
+		bool stealing_{true};
+		std::exception_ptr error_;
+
+		template <typename F>
+		void start(size_t tasks, F& f, bool stealing) {
+			std::lock_guard<std::mutex> turn{run_mutex_};
+			{
+				std::lock_guard<std::mutex> lock{mutex_};
+				task_ = [&f](size_t i) { f(i); };
+				for (size_t t = 0; t < size(); t++) {
+					ranges_[t].reset(tasks * t / size(), tasks * (t + 1) / size());
+				}
+				remaining_.store(tasks, std::memory_order_relaxed);
+				active_ = workers_.size();
+				error_ = nullptr;
+				stealing_ = stealing;
+				generation_++;
+			}
+			wake_.notify_all();
+			execute(0);
+			std::unique_lock<std::mutex> lock{mutex_};
+			done_.wait(lock, [this]() { return active_ == 0; });
+			task_ = nullptr;
+			if (error_) {
+				std::rethrow_exception(error_);
+			}
+		}
+
+		static std::vector<size_t> allowed_cpus() {
+			std::vector<size_t> cpus;
+			cpu_set_t set;
+			if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+				for (size_t c = 0; c < static_cast<size_t>(CPU_SETSIZE); c++) {
+					if (CPU_ISSET(c, &set)) {
+						cpus.push_back(c);
+					}
+				}
+			}
+			return cpus;
+		}
+
+		void work(size_t id) {
+			uint64_t seen = 0;
+			for (;;) {
+				{
+					std::unique_lock<std::mutex> lock{mutex_};
+					wake_.wait(lock, [this, seen]() { return stop_ || generation_ != seen; });
+					if (stop_) {
+						return;
+					}
+					seen = generation_;
+				}
+				execute(id);
+				std::lock_guard<std::mutex> lock{mutex_};
+				if (--active_ == 0) {
+					done_.notify_one();
+				}
+			}
+		}
+
+		void run_task(size_t task) {
+			try {
+				task_(task);
+			} catch (...) {
+				std::lock_guard<std::mutex> lock{mutex_};
+				if (!error_) {
+					error_ = std::current_exception();
+				}
+				// Drop every task that has not started
+				for (size_t t = 0; t < size(); t++) {
+					uint64_t first, last;
+					while (ranges_[t].steal(first, last)) {
+						remaining_.fetch_sub(static_cast<size_t>(last - first), std::memory_order_relaxed);
+					}
+					size_t dropped;
+					while (ranges_[t].pop(dropped)) {
+						remaining_.fetch_sub(1, std::memory_order_relaxed);
+					}
+				}
+			}
+			remaining_.fetch_sub(1, std::memory_order_release);
+		}
+
+		void execute(size_t id) {
+			detail::inside_pool() = true;
+			auto& own = ranges_[id];
+			uint64_t rng = 0x9e3779b97f4a7c15ull * (id + 1);
+			while (remaining_.load(std::memory_order_acquire) > 0) {
+				size_t task;
+				if (own.pop(task)) {
+					run_task(task);
+					continue;
+				}
+				if (!stealing_) {
+					std::this_thread::yield();
+					continue;
+				}
+				// xorshift64 to pick a victim
+				rng ^= rng << 13;
+				rng ^= rng >> 7;
+				rng ^= rng << 17;
+				size_t const victim = static_cast<size_t>(rng % size());
+				uint64_t first, last;
+				if (victim != id && ranges_[victim].steal(first, last)) {
+					steals_.fetch_add(1, std::memory_order_relaxed);
+					// Only this thread adds to its own range, and it is empty
+					own.reset(first, last);
+				} else {
+					std::this_thread::yield();
+				}
+			}
+			detail::inside_pool() = false;
+		}
+	};
+
+	/**
+	 * \brief The pool used by the parallel algorithms when none is given
+	 *
+	 * It has one thread per hardware thread and is created on first use.
+	 */
+	inline thread_pool& default_pool() {
+		static thread_pool pool;
+		return pool;
+	}
+}